@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/AdaptiveRate.cpp
+ */
+
+#include "AdaptiveRate.h"
+
+#include <math.h>
+
+namespace sensors
+{
+
+bool AdaptiveRate::Add(float x, float y, float z)
+{
+    // running mean and variance of the magnitude (Welford), independent of the orientation
+    float m = sqrtf(x * x + y * y + z * z);
+    count++;
+    float d = m - mean;
+    mean += d / count;
+    m2 += d * (m - mean);
+
+    if (count < settings.window)
+    {
+        return false;
+    }
+
+    float variance = m2 / count;
+    deviation = sqrtf(variance);
+    count = 0;
+    mean = m2 = 0;
+
+    auto prev = level;
+    if (variance >= settings.motion * settings.motion)
+    {
+        // motion gets full bandwidth right away
+        level = settings.levels - 1;
+        quiet = 0;
+    }
+    else if (variance < settings.rest * settings.rest)
+    {
+        // rest is confirmed over several windows and the rate is reduced gradually
+        if (++quiet >= settings.holdWindows && level > 0)
+        {
+            level--;
+            quiet = 0;
+        }
+    }
+    else
+    {
+        quiet = 0;
+    }
+
+    return level != prev;
+}
+
+bool AdaptiveRate::Activity()
+{
+    auto prev = level;
+    level = settings.levels - 1;
+    quiet = 0;
+    // the statistics of the current window no longer apply
+    count = 0;
+    mean = m2 = 0;
+    return level != prev;
+}
+
+}
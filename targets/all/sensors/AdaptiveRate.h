@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/AdaptiveRate.h
+ *
+ * Selection of a sampling level (output data rate, FIFO watermark) based on
+ * the activity of the measured acceleration, the levels themselves are defined
+ * by the application and applied through the Configure*() and ApplyConfiguration
+ * methods of the drivers, which write only the registers that have changed
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+namespace sensors
+{
+
+class AdaptiveRate
+{
+public:
+    struct Settings
+    {
+        //! Number of levels, level 0 is the slowest
+        uint8_t levels;
+        //! Number of consecutive quiet windows required to step one level down
+        uint8_t holdWindows;
+        //! Number of samples evaluated together
+        uint16_t window;
+        //! Standard deviation of the acceleration magnitude (in g) that selects the fastest level
+        float motion;
+        //! Standard deviation of the acceleration magnitude (in g) below which a window is quiet
+        float rest;
+    };
+
+    //! Creates the controller, starting at the fastest level
+    AdaptiveRate(const Settings& settings)
+        : settings(settings), level(settings.levels - 1)
+    {
+        ASSERT(settings.levels > 0 && settings.window > 1 && settings.rest <= settings.motion);
+    }
+
+    //! Adds an acceleration sample, returns true if the selected level has changed
+    bool Add(float x, float y, float z);
+    //! Reports activity detected by the sensor itself (e.g. a wake-up interrupt),
+    //! selects the fastest level immediately, returns true if the selected level has changed
+    bool Activity();
+
+    //! Gets the selected level
+    unsigned Level() const { return level; }
+    //! Gets the standard deviation of the acceleration magnitude in the last complete window
+    float Deviation() const { return deviation; }
+
+private:
+    Settings settings;
+    uint8_t level;
+    uint8_t quiet = 0;
+    uint16_t count = 0;
+    float mean = 0, m2 = 0;
+    float deviation = 0;
+};
+
+}
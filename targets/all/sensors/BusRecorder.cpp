@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/BusRecorder.cpp
+ */
+
+#include "BusRecorder.h"
+
+namespace sensors
+{
+
+void BusRecorder::Log(uint8_t device, uint8_t reg, bool write, bool success, const void* data, size_t length)
+{
+    if (!active)
+    {
+        return;
+    }
+
+    Header hdr;
+    hdr.time = uint32_t(MonoToMicroseconds(MONO_CLOCKS - start));
+    hdr.device = device;
+    hdr.flags = FlagWrite * write | FlagFailed * !success;
+    hdr.reg = reg;
+    hdr.length = uint16_t(length);
+
+    size_t payload = hdr.PayloadLength();
+    if (length > UINT16_MAX || used + sizeof(hdr) + payload > storage.Length())
+    {
+        lost++;
+        return;
+    }
+
+    auto p = (uint8_t*)storage.Pointer() + used;
+    memcpy(p, &hdr, sizeof(hdr));
+    memcpy(p + sizeof(hdr), data, payload);
+    used += sizeof(hdr) + payload;
+}
+
+}
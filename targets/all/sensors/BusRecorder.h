@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/BusRecorder.h
+ *
+ * Compact binary log of register transactions, filled by sensor interfaces
+ * compiled with SENSOR_RECORD and consumed by @ref ReplayInterface
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+namespace sensors
+{
+
+class BusRecorder
+{
+public:
+    //! Flags of a recorded transaction
+    enum Flags : uint8_t
+    {
+        //! Registers were written, otherwise read
+        FlagWrite = 1,
+        //! The transaction failed, no payload follows for failed reads
+        FlagFailed = 2,
+    };
+
+    //! Header of a single record, followed by the payload
+    PACKED_UNALIGNED_STRUCT Header
+    {
+        //! Microseconds since @ref Start, wraps after ~71 minutes
+        uint32_t time;
+        //! Device identifier assigned in @ref Interface::Record
+        uint8_t device;
+        //! Combination of @ref Flags
+        uint8_t flags;
+        //! First register address
+        uint8_t reg;
+        //! Number of register bytes transferred
+        uint16_t length;
+
+        bool Write() const { return flags & FlagWrite; }
+        bool Failed() const { return flags & FlagFailed; }
+        //! Number of payload bytes following the header
+        size_t PayloadLength() const { return Failed() && !Write() ? 0 : length; }
+    };
+
+    //! Creates a recorder storing the records in the provided buffer
+    BusRecorder(Buffer storage)
+        : storage(storage) {}
+
+    //! Clears the log and starts recording
+    void Start() { used = 0; lost = 0; start = MONO_CLOCKS; active = true; }
+    //! Stops recording, the log remains available
+    void Stop() { active = false; }
+    //! Checks if the recorder is currently accepting records
+    bool Active() const { return active; }
+
+    //! Appends a transaction to the log, records that do not fit are dropped and counted
+    void Log(uint8_t device, uint8_t reg, bool write, bool success, const void* data, size_t length);
+
+    //! Gets the recorded session
+    Span Data() const { return Span(storage.Pointer(), used); }
+    //! Gets the number of records dropped because the storage was full
+    uint32_t Lost() const { return lost; }
+
+private:
+    Buffer storage;
+    size_t used = 0;
+    uint32_t lost = 0;
+    mono_t start = 0;
+    bool active = false;
+};
+
+}
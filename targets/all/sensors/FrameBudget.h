@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/FrameBudget.h
+ *
+ * Compile-time accounting of the RAM taken by async frames of the drivers,
+ * the sizes cover the kernel frame header and the fields declared in async_def,
+ * SENSOR_FRAME_FIELDS checks them against the actual frame in both directions,
+ * the nested calls listed in the FrameSizes tables have to be kept in sync
+ * with the awaits in the driver sources by hand
+ *
+ * All tables include the frames of the external operations they await
+ * (bus transfers, pipes, GPIO waits), these are not part of this library
+ * so their worst case is taken from SENSOR_FRAME_BUS
+ *
+ * SENSOR_FRAME_OVERHEAD - additional kernel overhead for every nesting level
+ * SENSOR_FRAME_BUS - worst-case size of the nested frames of a single
+ *                    external operation (bus::I2C, bus::SPI, io pipes, GPIO)
+ * SENSOR_FRAME_REPORT - emits a symbol named sensor_frame_<driver>_<entry>,
+ *                       sized as the worst-case nested frame size, for every
+ *                       checked entry point, list them using nm -S -C on the
+ *                       object files
+ * SENSOR_FRAME_BUDGET - fails the build if any checked entry point exceeds
+ *                       the specified number of bytes
+ * SENSOR_FRAME_BUDGET_<driver> - overrides SENSOR_FRAME_BUDGET for a single
+ *                                driver, e.g. SENSOR_FRAME_BUDGET_LSM6DSO
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#ifndef SENSOR_FRAME_OVERHEAD
+#define SENSOR_FRAME_OVERHEAD   0
+#endif
+
+#ifndef SENSOR_FRAME_BUS
+#define SENSOR_FRAME_BUS        0
+#endif
+
+#ifndef SENSOR_FRAME_BUDGET
+#define SENSOR_FRAME_BUDGET     0
+#endif
+
+namespace sensors
+{
+
+namespace frame_budget_impl
+{
+
+//! Placeholder for a field that is not present in the current configuration
+struct NoField {};
+
+template<typename T> constexpr size_t FieldSize = sizeof(T);
+template<> constexpr size_t FieldSize<NoField> = 0;
+template<typename T> constexpr size_t FieldAlign = alignof(T);
+template<> constexpr size_t FieldAlign<NoField> = 1;
+
+constexpr size_t AlignUp(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+//! Computes the size of a structure consisting of the kernel frame header followed by fields of the specified types
+template<typename... T> constexpr size_t Layout()
+{
+    size_t size = sizeof(AsyncFrame), align = alignof(AsyncFrame);
+    ((size = AlignUp(size, FieldAlign<T>) + FieldSize<T>, align = align > FieldAlign<T> ? align : FieldAlign<T>), ...);
+    return AlignUp(size, align);
+}
+
+}
+
+//! Size of an async frame declaring fields of the specified types, in order
+template<typename... T> constexpr size_t FrameSize = frame_budget_impl::Layout<T...>() + SENSOR_FRAME_OVERHEAD;
+
+//! Frame size of an async function, split into its own frame and the worst case of the calls nested in it
+struct FrameEntry
+{
+    size_t own, nested;
+
+    constexpr operator size_t() const { return own + nested; }
+};
+
+//! Frame field present only when performance counters are enabled, see @ref SensorStats
+#if SENSOR_STATS
+using FrameStatsStart = mono_t;
+#else
+using FrameStatsStart = frame_budget_impl::NoField;
+#endif
+
+//! Gets the largest of the frame sizes of alternative nested calls
+constexpr size_t FrameMax(size_t a, size_t b) { return a > b ? a : b; }
+template<typename... Rest> constexpr size_t FrameMax(size_t a, size_t b, Rest... rest) { return FrameMax(FrameMax(a, b), rest...); }
+
+}
+
+#if SENSOR_FRAME_REPORT
+#define _SENSOR_FRAME_REPORT(cls, entry, size) \
+    __attribute__((used, section(".sensor_frames"))) static const char sensor_frame_##cls##_##entry[(size)] = {}
+#else
+#define _SENSOR_FRAME_REPORT(cls, entry, size) static_assert(true)
+#endif
+
+//! Reports the worst-case frame size of a driver entry point and checks it against the budget of the driver,
+//! the driver source must define SENSOR_FRAME_BUDGET_<cls>, defaulting to SENSOR_FRAME_BUDGET
+#define SENSOR_FRAME_CHECK(cls, entry, size) \
+    _SENSOR_FRAME_REPORT(cls, entry, size); \
+    static_assert(!SENSOR_FRAME_BUDGET_##cls || (size) <= SENSOR_FRAME_BUDGET_##cls, #cls "::" #entry " exceeds SENSOR_FRAME_BUDGET_" #cls)
+
+//! Checks that the fields declared by the enclosing async_def match the own frame accounted for them in a FrameSizes table
+#define SENSOR_FRAME_FIELDS(entry) \
+    static_assert(sizeof(f) + SENSOR_FRAME_OVERHEAD == (entry).own, "async_def fields differ from " #entry)
@@ -27,6 +27,10 @@ protected:
     virtual async(WriteRegisterImpl, Interface::RegAndLength arg, const void* buf) final override
         { return async_forward(I2CSensor::WriteRegisterImpl, arg, buf); }
 
+#if SENSOR_STATS
+    virtual SensorStats& Stats() final override { return I2CSensor::Stats(); }
+#endif
+
 #if TRACE
     virtual const char* DebugComponent() const final override { return OwnerDebugComponent(); }
     virtual void _DebugHeader() const final override { I2CSensor::_DebugHeader(); }
@@ -14,8 +14,15 @@ namespace sensors
 async(I2CSensor::ReadRegisterImpl, RegAndLength arg, void* buf)
 async_def(
     uint8_t reg;
+#if SENSOR_STATS
+    mono_t start;
+#endif
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadRegisterImpl);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
     // we don't want to be passing a stack value to Write
     f.reg = arg.reg;
     if (!await(Write, f.reg, arg.length ? Next::Restart : Next::Stop))
@@ -24,7 +31,7 @@ async_def(
         {
             MYDBG("Failed to write register %02X address", arg.reg);
         }
-        async_return(false);
+        async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, false));
     }
 
     if (arg.length)
@@ -32,25 +39,46 @@ async_def(
         if (!await(Read, Buffer(buf, arg.length)))
         {
             MYDBG("Failed to read register %02X value, error at %d/%d", arg.reg, Transferred(), arg.length);
-            async_return(false);
+            async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, false));
         }
     }
 
-    async_return(true);
+    async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, true));
 }
 async_end
 
 async(I2CSensor::WriteRegisterImpl, RegAndLength arg, const void* buf)
 async_def(
     uint8_t reg;
+    uint8_t merged[1 + MaxMergedWrite];
+#if SENSOR_STATS
+    mono_t start;
+#endif
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::WriteRegisterImpl);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
+    if (arg.length && arg.length <= MaxMergedWrite)
+    {
+        // short writes are sent in a single transfer, the data directly following the register address
+        f.merged[0] = arg.reg;
+        memcpy(f.merged + 1, buf, arg.length);
+        if (!await(Write, Span(f.merged, arg.length + 1)))
+        {
+            MYDBG("Failed to write register %02X value, error at %d/%d", arg.reg, Transferred(), arg.length + 1);
+            async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, false));
+        }
+        async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, true));
+    }
+
     // we don't want to be passing a stack value to Write
     f.reg = arg.reg;
     if (!await(Write, f.reg, arg.length ? Next::Continue : Next::Stop))
     {
         MYDBG("Failed to write register %02X address", arg.reg);
-        async_return(false);
+        async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, false));
     }
 
     if (arg.length)
@@ -58,6 +86,68 @@ async_def(
         if (!await(Write, Span(buf, arg.length)))
         {
             MYDBG("Failed to write register %02X value, error at %d/%d", arg.reg, Transferred(), arg.length);
+            async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, false));
+        }
+    }
+
+    async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, true));
+}
+async_end
+
+async(I2CSensor::UpdateRegistersImpl, RegisterBursts bursts)
+async_def(
+    RegisterBursts bursts;
+    RegisterBursts::Burst burst;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::UpdateRegisters);
+    f.bursts = bursts;
+    while ((f.burst = f.bursts.Next()))
+    {
+        MYTRACE("Updating registers %02X-%02X", f.bursts.Register(f.burst), f.bursts.Register(f.burst) + f.burst.length - 1);
+        if (!await(WriteRegisterImpl, RegAndLength(f.bursts.Register(f.burst), f.burst.length), f.bursts.Desired(f.burst)))
+        {
+            async_return(false);
+        }
+        f.bursts.Commit(f.burst);
+    }
+
+    async_return(true);
+}
+async_end
+
+async(I2CSensor::ReadCachedImpl, RegAndLength arg, void* buf, RegisterShadow shadow)
+async_def(
+    RegisterShadow shadow;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadCached);
+    if (shadow.Read(arg.reg, buf, arg.length))
+    {
+        async_return(true);
+    }
+
+    f.shadow = shadow;
+    if (!await(ReadRegisterImpl, arg, buf))
+    {
+        async_return(false);
+    }
+
+    f.shadow.Store(arg.reg, buf, arg.length);
+    async_return(true);
+}
+async_end
+
+async(I2CSensor::WriteSequence, const RegisterWrite* seq, size_t count)
+async_def(
+    size_t i;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::WriteSequence);
+    for (f.i = 0; f.i < count; f.i++)
+    {
+        if (!await(WriteRegisterImpl, RegAndLength(seq[f.i].reg, seq[f.i].length), seq[f.i].data))
+        {
             async_return(false);
         }
     }
@@ -66,4 +156,33 @@ async_def(
 }
 async_end
 
+async(I2CSensor::ReadSequence, const RegisterRead* seq, size_t count)
+async_def(
+    size_t i;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadSequence);
+    for (f.i = 0; f.i < count; f.i++)
+    {
+        if (!await(ReadRegisterImpl, RegAndLength(seq[f.i].reg, seq[f.i].length), seq[f.i].data))
+        {
+            async_return(false);
+        }
+    }
+
+    async_return(true);
+}
+async_end
+
+#ifndef SENSOR_FRAME_BUDGET_I2CSensor
+#define SENSOR_FRAME_BUDGET_I2CSensor    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(I2CSensor, ReadRegisterImpl, I2CSensor::FrameSizes::ReadRegisterImpl);
+SENSOR_FRAME_CHECK(I2CSensor, WriteRegisterImpl, I2CSensor::FrameSizes::WriteRegisterImpl);
+SENSOR_FRAME_CHECK(I2CSensor, UpdateRegisters, I2CSensor::FrameSizes::UpdateRegisters);
+SENSOR_FRAME_CHECK(I2CSensor, ReadCached, I2CSensor::FrameSizes::ReadCached);
+SENSOR_FRAME_CHECK(I2CSensor, ReadSequence, I2CSensor::FrameSizes::ReadSequence);
+SENSOR_FRAME_CHECK(I2CSensor, WriteSequence, I2CSensor::FrameSizes::WriteSequence);
+
 }
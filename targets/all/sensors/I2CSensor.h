@@ -12,7 +12,11 @@
 
 #include <bus/I2C.h>
 
+#include "FrameBudget.h"
 #include "Interface.h"
+#include "RegisterBursts.h"
+#include "RegisterMap.h"
+#include "SensorStats.h"
 
 namespace sensors
 {
@@ -34,6 +38,21 @@ protected:
     template<typename T> async(ReadRegister, T reg, Buffer buf, bool allowFail = false) { return async_forward(ReadRegisterImpl, RegAndLength(uint8_t(reg), buf.Length(), allowFail), buf.Pointer()); }
     //! Writes data to consecutive registers (register address is written as the first byte)
     template<typename T> async(WriteRegister, T reg, Span buf, bool allowFail = false) { return async_forward(WriteRegisterImpl, RegAndLength(uint8_t(reg), buf.Length(), allowFail), buf.Pointer()); }
+    //! Writes only the registers of a block that differ between the shadow copy @p actual and @p desired,
+    //! in as few bursts as possible, updating the shadow copy as the bursts are written
+    //! @param volatileMask bit mask of registers that are never compared nor written, see @ref RegisterBursts
+    template<typename TReg, typename T> async(UpdateRegisters, TReg reg, T& actual, const T& desired, uint32_t volatileMask = 0) { return async_forward(UpdateRegistersImpl, RegisterBursts(uint8_t(reg), actual, desired, volatileMask)); }
+    //! Reads data from registers of a block kept in the shadow copy @p actual, non-volatile registers
+    //! are served from the shadow copy without any bus traffic, see @ref RegisterShadow
+    template<typename TReg, typename T> async(ReadCached, TReg reg, Buffer buf, TReg block, T& actual, uint32_t volatileMask = 0) { return async_forward(ReadCachedImpl, RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer(), RegisterShadow(uint8_t(block), actual, volatileMask)); }
+    //! Reads a sequence of register blocks, stopping at the first failure
+    async(ReadSequence, const RegisterRead* seq, size_t count);
+    //! Reads a sequence of register blocks, stopping at the first failure
+    template<size_t n> async(ReadSequence, const RegisterRead (&seq)[n]) { return async_forward(ReadSequence, seq, n); }
+    //! Writes a sequence of register bursts, stopping at the first failure
+    async(WriteSequence, const RegisterWrite* seq, size_t count);
+    //! Writes a sequence of register bursts, stopping at the first failure
+    template<size_t n> async(WriteSequence, const RegisterWrite (&seq)[n]) { return async_forward(WriteSequence, seq, n); }
 
     uint8_t BusAddress() const { return dev.Address(); }
     unsigned Transferred() const { return dev.Transferred(); }
@@ -43,6 +62,12 @@ protected:
     //! Sets the current bus frequency
     void OutputFrequency(uint32_t freq) { dev.Bus().OutputFrequency(freq); }
 
+#if SENSOR_STATS
+    //! Gets the performance counters
+    const SensorStats& Statistics() const { return stats; }
+    SensorStats& Stats() { return stats; }
+#endif
+
 #if TRACE
     virtual const char* DebugComponent() const { return "I2CSensor"; }
     void _DebugHeader() const { DBG("%s[%02X]: ", DebugComponent(), BusAddress()); }
@@ -58,12 +83,43 @@ protected:
 #endif
 
 private:
+    enum
+    {
+        //! Register writes up to this length are merged with the register address into a single transfer
+        MaxMergedWrite = 15,
+    };
+
     bus::I2C::Device dev;
+#if SENSOR_STATS
+    SensorStats stats = {};
+#endif
 
     typedef Interface::RegAndLength RegAndLength;
 
     async(ReadRegisterImpl, RegAndLength arg, void* buf);
     async(WriteRegisterImpl, RegAndLength arg, const void* buf);
+    async(UpdateRegistersImpl, RegisterBursts bursts);
+    async(ReadCachedImpl, RegAndLength arg, void* buf, RegisterShadow shadow);
+
+public:
+    //! Worst-case size of the async frames of a bus transfer, see @ref FrameBudget.h
+    static constexpr size_t BusFrameSize = SENSOR_FRAME_BUS;                  // Read, Write
+
+    //! Worst-case sizes of the nested async frames
+    struct FrameSizes
+    {
+        static constexpr FrameEntry ReadRegisterImpl = { FrameSize<uint8_t, FrameStatsStart>, BusFrameSize };
+        static constexpr FrameEntry WriteRegisterImpl = { FrameSize<uint8_t, uint8_t[1 + MaxMergedWrite], FrameStatsStart>, BusFrameSize };
+        static constexpr FrameEntry UpdateRegisters = { FrameSize<RegisterBursts, RegisterBursts::Burst>, WriteRegisterImpl };
+        static constexpr FrameEntry ReadCached = { FrameSize<RegisterShadow>, ReadRegisterImpl };
+        static constexpr FrameEntry ReadSequence = { FrameSize<size_t>, ReadRegisterImpl };
+        static constexpr FrameEntry WriteSequence = { FrameSize<size_t>, WriteRegisterImpl };
+    };
+
+    //! Worst-case size of the async frames of a single register transfer
+    static constexpr size_t TransferFrameSize = FrameMax(FrameSizes::ReadRegisterImpl, FrameSizes::WriteRegisterImpl);
+    //! Worst-case size of the nested async frames of any register operation
+    static constexpr size_t RegisterFrameSize = FrameMax(FrameSizes::UpdateRegisters, FrameSizes::ReadCached, FrameSizes::ReadSequence, FrameSizes::WriteSequence);
 
     friend class I2CInterface;
 };
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/Interface.cpp
+ */
+
+#include "Interface.h"
+
+namespace sensors
+{
+
+async(Interface::ReadSequenceImpl, const RegisterRead* seq, size_t count)
+async_def(
+    size_t i;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes<0>::ReadSequenceImpl);
+    for (f.i = 0; f.i < count; f.i++)
+    {
+        if (!await(ReadRegisterImpl, RegAndLength(seq[f.i].reg, seq[f.i].length), seq[f.i].data))
+        {
+            async_return(false);
+        }
+    }
+
+    async_return(true);
+}
+async_end
+
+async(Interface::WriteSequence, const RegisterWrite* seq, size_t count)
+async_def(
+    size_t i;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes<0>::WriteSequence);
+    for (f.i = 0; f.i < count; f.i++)
+    {
+        if (!await(WriteRegister, RegAndLength(seq[f.i].reg, seq[f.i].length), seq[f.i].data))
+        {
+            async_return(false);
+        }
+    }
+
+    async_return(true);
+}
+async_end
+
+async(Interface::UpdateRegisters, RegisterBursts bursts)
+async_def(
+    RegisterBursts bursts;
+    RegisterBursts::Burst burst;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes<0>::UpdateRegisters);
+    f.bursts = bursts;
+    while ((f.burst = f.bursts.Next()))
+    {
+        if (!await(WriteRegister, RegAndLength(f.bursts.Register(f.burst), f.burst.length), f.bursts.Desired(f.burst)))
+        {
+            async_return(false);
+        }
+        f.bursts.Commit(f.burst);
+    }
+
+    async_return(true);
+}
+async_end
+
+async(Interface::ReadCached, RegAndLength arg, void* buf, RegisterShadow shadow)
+async_def(
+    RegisterShadow shadow;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes<0>::ReadCached);
+    if (shadow.Read(arg.reg, buf, arg.length))
+    {
+        async_return(true);
+    }
+
+    f.shadow = shadow;
+    if (!await(ReadRegister, arg, buf))
+    {
+        async_return(false);
+    }
+
+    f.shadow.Store(arg.reg, buf, arg.length);
+    async_return(true);
+}
+async_end
+
+#if SENSOR_RECORD
+
+async(Interface::ReadRegister, RegAndLength arg, void* buf)
+async_def(
+    bool success;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes<0>::ReadRegister);
+    f.success = await(ReadRegisterImpl, arg, buf);
+    if (recorder)
+    {
+        recorder->Log(recordDevice, arg.reg, false, f.success, buf, arg.length);
+    }
+    async_return(f.success);
+}
+async_end
+
+async(Interface::WriteRegister, RegAndLength arg, const void* buf)
+async_def(
+    bool success;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes<0>::WriteRegister);
+    f.success = await(WriteRegisterImpl, arg, buf);
+    if (recorder)
+    {
+        recorder->Log(recordDevice, arg.reg, true, f.success, buf, arg.length);
+    }
+    async_return(f.success);
+}
+async_end
+
+async(Interface::ReadSequence, const RegisterRead* seq, size_t count)
+async_def(
+    bool success;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes<0>::ReadSequence);
+    f.success = await(ReadSequenceImpl, seq, count);
+    if (recorder)
+    {
+        // the failing block is not known, a failed sequence is logged as failed in its entirety
+        for (size_t i = 0; i < count; i++)
+        {
+            recorder->Log(recordDevice, seq[i].reg, false, f.success, seq[i].data, seq[i].length);
+        }
+    }
+    async_return(f.success);
+}
+async_end
+
+#endif
+
+}
@@ -10,6 +10,12 @@
 
 #include <kernel/kernel.h>
 
+#include "BusRecorder.h"
+#include "FrameBudget.h"
+#include "RegisterBursts.h"
+#include "RegisterMap.h"
+#include "SensorStats.h"
+
 namespace sensors
 {
 
@@ -43,8 +49,65 @@ public:
 
     virtual async(ReadRegisterImpl, RegAndLength arg, void* buf) = 0;
     virtual async(WriteRegisterImpl, RegAndLength arg, const void* buf) = 0;
+    //! Reads a sequence of register blocks, stopping at the first failure
+    virtual async(ReadSequenceImpl, const RegisterRead* seq, size_t count);
+
+#if SENSOR_RECORD
+    //! Logs all following transactions of this interface into @p recorder under the specified @p device identifier
+    void Record(BusRecorder* recorder, uint8_t device) { this->recorder = recorder; this->recordDevice = device; }
+
+    //! Reads data from consecutive registers, logging the transaction
+    async(ReadRegister, RegAndLength arg, void* buf);
+    //! Writes data to consecutive registers, logging the transaction
+    async(WriteRegister, RegAndLength arg, const void* buf);
+    //! Reads a sequence of register blocks, stopping at the first failure, logging all blocks
+    async(ReadSequence, const RegisterRead* seq, size_t count);
+#else
+    //! Reads data from consecutive registers
+    async(ReadRegister, RegAndLength arg, void* buf) { return async_forward(ReadRegisterImpl, arg, buf); }
+    //! Writes data to consecutive registers
+    async(WriteRegister, RegAndLength arg, const void* buf) { return async_forward(WriteRegisterImpl, arg, buf); }
+    //! Reads a sequence of register blocks, stopping at the first failure
+    async(ReadSequence, const RegisterRead* seq, size_t count) { return async_forward(ReadSequenceImpl, seq, count); }
+#endif
+
+    //! Writes a sequence of register bursts, stopping at the first failure
+    async(WriteSequence, const RegisterWrite* seq, size_t count);
+    //! Writes the changed registers of a block, see @ref RegisterBursts
+    async(UpdateRegisters, RegisterBursts bursts);
+    //! Reads registers of a block, serving the non-volatile ones from its shadow copy, see @ref RegisterShadow
+    async(ReadCached, RegAndLength arg, void* buf, RegisterShadow shadow);
+
+#if SENSOR_STATS
+    //! Gets the performance counters of the underlying transport
+    virtual SensorStats& Stats() = 0;
+#endif
+
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h,
+    //! @p Impl is the worst case of the transfers implemented by the transports
+    template<size_t Impl> struct FrameSizes
+    {
+        static constexpr FrameEntry ReadSequenceImpl = { FrameSize<size_t>, Impl };
+#if SENSOR_RECORD
+        static constexpr FrameEntry ReadRegister = { FrameSize<bool>, Impl };
+        static constexpr FrameEntry WriteRegister = { FrameSize<bool>, Impl };
+        static constexpr FrameEntry ReadSequence = { FrameSize<bool>, FrameMax(Impl, ReadSequenceImpl) };
+#else
+        static constexpr size_t ReadRegister = Impl;                            // forwarded to ReadRegisterImpl
+        static constexpr size_t WriteRegister = Impl;                           // forwarded to WriteRegisterImpl
+        static constexpr size_t ReadSequence = FrameMax(Impl, ReadSequenceImpl);
+#endif
+        static constexpr FrameEntry WriteSequence = { FrameSize<size_t>, WriteRegister };
+        static constexpr FrameEntry UpdateRegisters = { FrameSize<RegisterBursts, RegisterBursts::Burst>, WriteRegister };
+        static constexpr FrameEntry ReadCached = { FrameSize<RegisterShadow>, ReadRegister };
+    };
 
 protected:
+#if SENSOR_RECORD
+    BusRecorder* recorder = nullptr;
+    uint8_t recordDevice = 0;
+#endif
+
 #if TRACE
     const class Sensor* _owner;
     const char* OwnerDebugComponent() const;
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/RegisterBursts.h
+ *
+ * Computes minimal register write bursts from a shadow copy of device registers
+ * and serves reads of non-volatile registers from it
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+namespace sensors
+{
+
+//! Enumerates bursts of consecutive registers that differ between the shadow copy
+//! of a register block and its desired state
+//!
+//! Short runs of unchanged registers between two changed ones are rewritten as part of
+//! a single burst, as that is cheaper than starting a new transfer. Volatile registers
+//! (modified by the device itself, self-clearing, read-only) are never compared nor written,
+//! bursts are split around them.
+class RegisterBursts
+{
+public:
+    enum
+    {
+        //! Maximum number of unchanged registers rewritten to join two bursts
+        MergeGap = 2,
+        //! Maximum size of the register block
+        MaxLength = 32,
+    };
+
+    struct Burst
+    {
+        //! Offset of the first register of the burst within the block
+        uint8_t offset;
+        //! Number of registers in the burst
+        uint8_t length;
+
+        constexpr explicit operator bool() const { return !!length; }
+    };
+
+    constexpr RegisterBursts() {}
+
+    //! Prepares the bursts for updating the register block starting at register @p reg
+    //! @param volatileMask bit mask of volatile registers, bit 0 corresponding to @p reg
+    template<typename T> RegisterBursts(uint8_t reg, T& actual, const T& desired, uint32_t volatileMask = 0)
+        : actual((uint8_t*)&actual), desired((const uint8_t*)&desired), volatileMask(volatileMask), reg(reg), length(sizeof(T))
+    {
+        static_assert(sizeof(T) <= MaxLength, "Register block too large");
+    }
+
+    //! Gets the next burst to be written, an empty burst if there are no more changes
+    Burst Next()
+    {
+        while (pos < length && !Dirty(pos)) { pos++; }
+        if (pos == length)
+        {
+            return {};
+        }
+
+        uint8_t start = pos, end = ++pos;
+        while (pos < length && !Volatile(pos))
+        {
+            if (Dirty(pos))
+            {
+                end = pos + 1;
+            }
+            else if (pos - end >= MergeGap)
+            {
+                break;
+            }
+            pos++;
+        }
+
+        pos = end;
+        return { start, uint8_t(end - start) };
+    }
+
+    //! Gets the first register of the burst
+    uint8_t Register(Burst burst) const { return reg + burst.offset; }
+    //! Gets the desired values of the registers in the burst
+    const void* Desired(Burst burst) const { return desired + burst.offset; }
+    //! Updates the shadow copy after the burst has been successfully written
+    void Commit(Burst burst) { memcpy(actual + burst.offset, desired + burst.offset, burst.length); }
+
+private:
+    uint8_t* actual = NULL;
+    const uint8_t* desired = NULL;
+    uint32_t volatileMask = 0;
+    uint8_t reg = 0, length = 0, pos = 0;
+
+    bool Volatile(unsigned i) const { return volatileMask & BIT(i); }
+    bool Dirty(unsigned i) const { return !Volatile(i) && actual[i] != desired[i]; }
+};
+
+
+//! Serves reads of the non-volatile registers of a block from its shadow copy,
+//! the same copy that is kept up to date by @ref RegisterBursts
+class RegisterShadow
+{
+public:
+    constexpr RegisterShadow() {}
+
+    //! Describes the shadow copy of the register block starting at register @p reg
+    //! @param volatileMask bit mask of volatile registers, bit 0 corresponding to @p reg
+    template<typename T> RegisterShadow(uint8_t reg, T& actual, uint32_t volatileMask = 0)
+        : actual((uint8_t*)&actual), volatileMask(volatileMask), reg(reg), length(sizeof(T))
+    {
+        static_assert(sizeof(T) <= RegisterBursts::MaxLength, "Register block too large");
+    }
+
+    //! Copies the values of @p count registers starting at @p first from the shadow copy,
+    //! fails if any of them is volatile or outside of the block and must be read from the device
+    bool Read(uint8_t first, void* buf, size_t count) const
+    {
+        if (first < reg || first + count > reg + length || (volatileMask & uint32_t((1ull << count) - 1) << (first - reg)))
+        {
+            return false;
+        }
+        memcpy(buf, actual + (first - reg), count);
+        return true;
+    }
+
+    //! Updates the shadow copy with the values of registers read from the device
+    void Store(uint8_t first, const void* buf, size_t count)
+    {
+        unsigned start = first > reg ? first : reg;
+        unsigned end = first + count < reg + length ? first + count : reg + length;
+        if (start < end)
+        {
+            memcpy(actual + (start - reg), (const uint8_t*)buf + (start - first), end - start);
+        }
+    }
+
+private:
+    uint8_t* actual = NULL;
+    uint32_t volatileMask = 0;
+    uint8_t reg = 0, length = 0;
+};
+
+}
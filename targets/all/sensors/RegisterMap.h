@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/RegisterMap.h
+ *
+ * Compile-time description of device register maps
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+namespace sensors
+{
+
+//! Register access mode
+enum struct RegisterAccess : uint8_t
+{
+    Read = 1,
+    Write = 2,
+    ReadWrite = 3,
+};
+
+//! Description of a register or a group of consecutive registers with the same properties
+struct RegisterInfo
+{
+    constexpr RegisterInfo()
+        : address(0), width(0), access(RegisterAccess(0)), reset(0) {}
+    template<typename T> constexpr RegisterInfo(T address, RegisterAccess access, uint8_t reset = 0, uint8_t width = 1)
+        : address(uint8_t(address)), width(width), access(access), reset(reset) {}
+
+    //! Address of the first register
+    uint8_t address;
+    //! Number of consecutive registers described
+    uint8_t width;
+    //! Access mode
+    RegisterAccess access;
+    //! Value of the register(s) after reset
+    uint8_t reset;
+
+    constexpr bool Contains(uint8_t addr) const { return addr >= address && addr < address + width; }
+};
+
+//! Register map of a device, used to validate register bursts and prepare
+//! initialization sequences at compile time
+template<size_t N> struct RegisterMap
+{
+    constexpr RegisterMap(uint8_t autoIncrement, const RegisterInfo (&regs)[N])
+        : regs(), autoIncrement(autoIncrement)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            this->regs[i] = regs[i];
+        }
+    }
+
+    //! Registers sorted by address
+    RegisterInfo regs[N];
+    //! Bit that must be set in the register address to enable auto-increment in bursts, zero if not needed
+    uint8_t autoIncrement;
+
+    //! Gets the address of the register without the auto-increment flag
+    template<typename T> constexpr uint8_t Address(T reg) const { return uint8_t(reg) & ~autoIncrement; }
+
+    //! Finds the description of the specified register, NULL if not part of the map
+    template<typename T> constexpr const RegisterInfo* Find(T reg) const
+    {
+        for (auto& r : regs)
+        {
+            if (r.Contains(Address(reg)))
+            {
+                return &r;
+            }
+        }
+        return NULL;
+    }
+
+    //! Checks if a burst of @p length registers starting at @p reg consists only of registers with the specified access
+    template<typename T> constexpr bool Burst(T reg, size_t length, RegisterAccess access) const
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            auto r = Find(Address(reg) + i);
+            if (!r || (uint8_t(r->access) & uint8_t(access)) != uint8_t(access))
+            {
+                return false;
+            }
+        }
+        return length == 1 || autoIncrement == 0 || (uint8_t(reg) & autoIncrement);
+    }
+
+    //! Checks if the registers can be read using a single burst
+    template<typename T> constexpr bool Readable(T reg, size_t length = 1) const { return Burst(reg, length, RegisterAccess::Read); }
+    //! Checks if the registers can be written using a single burst
+    template<typename T> constexpr bool Writable(T reg, size_t length = 1) const { return Burst(reg, length, RegisterAccess::Write); }
+
+    //! Gets the reset value of the specified register
+    template<typename T> constexpr uint8_t ResetValue(T reg) const { auto r = Find(reg); return r ? r->reset : 0; }
+
+    //! Fills @p buf with the reset values of @p length registers starting at @p reg
+    template<typename T> constexpr void ResetValues(T reg, uint8_t* buf, size_t length) const
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            buf[i] = ResetValue(Address(reg) + i);
+        }
+    }
+
+    //! Gets the address to be used for a burst starting at @p reg
+    template<typename T> constexpr uint8_t BurstAddress(T reg) const { return uint8_t(reg) | autoIncrement; }
+};
+
+template<size_t N> RegisterMap(uint8_t, const RegisterInfo (&)[N]) -> RegisterMap<N>;
+
+//! Single register read of a sequence, see ReadSequence
+struct RegisterRead
+{
+    //! First register
+    uint8_t reg;
+    //! Number of registers to read
+    uint16_t length;
+    //! Buffer receiving the values
+    void* data;
+};
+
+//! Single register write of a sequence, see WriteSequence
+struct RegisterWrite
+{
+    //! First register
+    uint8_t reg;
+    //! Number of registers to write
+    uint8_t length;
+    //! Values to be written
+    const void* data;
+};
+
+}
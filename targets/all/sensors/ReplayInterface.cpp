@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/ReplayInterface.cpp
+ */
+
+#include "ReplayInterface.h"
+
+namespace sensors
+{
+
+size_t ReplayInterface::NextRecord(size_t offset, BusRecorder::Header& hdr) const
+{
+    while (offset + sizeof(hdr) <= session.Length())
+    {
+        memcpy(&hdr, (const uint8_t*)session.Pointer() + offset, sizeof(hdr));
+        if (hdr.device == device)
+        {
+            return offset;
+        }
+        offset += sizeof(hdr) + hdr.PayloadLength();
+    }
+
+    return session.Length();
+}
+
+mono_t ReplayInterface::ReplayTime(const BusRecorder::Header& hdr)
+{
+    if (!started)
+    {
+        started = true;
+        firstTime = hdr.time;
+        startTime = MONO_CLOCKS;
+    }
+    return startTime + MonoFromMicroseconds(hdr.time - firstTime);
+}
+
+async(ReplayInterface::ReadRegisterImpl, Interface::RegAndLength arg, void* buf)
+async_def(
+    BusRecorder::Header hdr;
+    size_t pos;
+    uint32_t skip;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadRegisterImpl);
+    // writes and reads that the driver no longer performs are skipped until a matching read is found
+    for (f.pos = NextRecord(offset, f.hdr), f.skip = 0;
+        f.pos < session.Length();
+        f.pos = NextRecord(f.pos + sizeof(f.hdr) + f.hdr.PayloadLength(), f.hdr), f.skip++)
+    {
+        if (!f.hdr.Write() && f.hdr.reg == arg.reg && f.hdr.length == arg.length)
+        {
+            break;
+        }
+    }
+
+    if (f.pos >= session.Length())
+    {
+        MYDBG("no recorded read of %02X (%d bytes)", arg.reg, arg.length);
+        unmatched++;
+        async_return(false);
+    }
+
+    if (paced)
+    {
+        async_delay_until(ReplayTime(f.hdr));
+    }
+
+    offset = f.pos + sizeof(f.hdr) + f.hdr.PayloadLength();
+    skipped += f.skip;
+    if (f.hdr.Failed())
+    {
+        async_return(false);
+    }
+
+    memcpy(buf, (const uint8_t*)session.Pointer() + f.pos + sizeof(f.hdr), arg.length);
+    async_return(true);
+}
+async_end
+
+async(ReplayInterface::WriteRegisterImpl, Interface::RegAndLength arg, const void* buf)
+async_def_sync()
+{
+    // only a write that is next in the session is consumed, additional writes of a modified driver succeed
+    BusRecorder::Header hdr;
+    size_t pos = NextRecord(offset, hdr);
+    if (pos < session.Length() && hdr.Write() && hdr.reg == arg.reg)
+    {
+        offset = pos + sizeof(hdr) + hdr.PayloadLength();
+        async_return(!hdr.Failed());
+    }
+
+    async_return(true);
+}
+async_end
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/ReplayInterface.h
+ *
+ * Interface serving register transactions from a session captured
+ * by @ref BusRecorder instead of real hardware, used to reproduce
+ * field issues and evaluate driver changes against recorded traffic
+ */
+
+#pragma once
+
+#include "Interface.h"
+
+namespace sensors
+{
+
+class ReplayInterface : public Interface
+{
+public:
+    //! Creates an interface replaying the records of a single device
+    //! @param session data obtained from @ref BusRecorder::Data
+    //! @param device identifier under which the device was recorded
+    //! @param paced when set, reads are delayed to preserve the recorded timing
+    ReplayInterface(Span session, uint8_t device, bool paced = false)
+        : session(session), device(device), paced(paced) {}
+
+    //! Checks if all records of the device have been consumed
+    bool Finished() const { BusRecorder::Header hdr; return NextRecord(offset, hdr) >= session.Length(); }
+    //! Gets the number of recorded transactions skipped to find a matching read
+    uint32_t Skipped() const { return skipped; }
+    //! Gets the number of reads for which no matching record was found
+    uint32_t Unmatched() const { return unmatched; }
+
+protected:
+    virtual async(ReadRegisterImpl, Interface::RegAndLength arg, void* buf) final override;
+    virtual async(WriteRegisterImpl, Interface::RegAndLength arg, const void* buf) final override;
+
+#if SENSOR_STATS
+    virtual SensorStats& Stats() final override { return stats; }
+#endif
+
+#if TRACE
+    virtual void _DebugHeader() const final override { DBG("%s[replay %d]: ", OwnerDebugComponent(), device); }
+    template<typename... Args> void MYDBG(Args... args) { _DebugHeader(); _DBG(args...); _DBGCHAR('\n'); }
+#else
+    template<typename... Args> void MYDBG(Args...) {}
+#endif
+
+private:
+    Span session;
+    size_t offset = 0;
+    uint32_t skipped = 0, unmatched = 0;
+    uint8_t device;
+    bool paced;
+    bool started = false;
+    uint32_t firstTime;
+    mono_t startTime;
+#if SENSOR_STATS
+    SensorStats stats = {};
+#endif
+
+    //! Finds the next record of the device at or after @p offset, returns the offset of the record
+    size_t NextRecord(size_t offset, BusRecorder::Header& hdr) const;
+    //! Gets the time at which a record should be replayed when pacing
+    mono_t ReplayTime(const BusRecorder::Header& hdr);
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry ReadRegisterImpl = { FrameSize<BusRecorder::Header, size_t, uint32_t>, 0 };
+    };
+};
+
+}
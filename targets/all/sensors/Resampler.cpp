@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/Resampler.cpp
+ */
+
+#include "Resampler.h"
+
+#include <math.h>
+
+namespace sensors
+{
+
+bool ResamplerChannel::Push(mono_t time, const float* values)
+{
+    if (count && mono_signed_t(time - Time(count - 1)) < 0)
+    {
+        // out of order, would break the search for the samples around the frame time
+        return false;
+    }
+
+    if (count == capacity)
+    {
+        head = Index(1);
+        count--;
+        overflows++;
+    }
+
+    auto i = Index(count++);
+    times[i] = time;
+    memcpy(this->values + i * dim, values, dim * sizeof(float));
+    return true;
+}
+
+bool ResamplerChannel::Evaluate(mono_t t, float* out) const
+{
+    // find the last sample at or before t, older samples have already been discarded
+    unsigned n = 0;
+    while (n < count && mono_signed_t(Time(n) - t) <= 0)
+    {
+        n++;
+    }
+
+    if (n == 0 || (maxAge && t - Time(n - 1) > maxAge))
+    {
+        for (unsigned d = 0; d < dim; d++)
+        {
+            out[d] = NAN;
+        }
+        return false;
+    }
+
+    auto a = Values(n - 1);
+    if (mode == Mode::Linear && n < count && Time(n - 1) != t)
+    {
+        auto b = Values(n);
+        float k = float(t - Time(n - 1)) / float(Time(n) - Time(n - 1));
+        for (unsigned d = 0; d < dim; d++)
+        {
+            out[d] = a[d] + (b[d] - a[d]) * k;
+        }
+    }
+    else
+    {
+        memcpy(out, a, dim * sizeof(float));
+    }
+    return true;
+}
+
+void ResamplerChannel::Discard(mono_t t)
+{
+    // keep one sample at or before t, the following frames are evaluated relative to it
+    while (count >= 2 && mono_signed_t(Time(1) - t) <= 0)
+    {
+        head = Index(1);
+        count--;
+    }
+}
+
+void Resampler::Add(ResamplerChannel& channel)
+{
+    ASSERT(channels < MaxChannels && !channel.next);
+    *last = &channel;
+    last = &channel.next;
+    channels++;
+    length += channel.dim;
+    started = false;
+}
+
+bool Resampler::Next(mono_t now, float* values, Frame& frame)
+{
+    if (!first)
+    {
+        return false;
+    }
+
+    if (!started)
+    {
+        // the first frame is at the latest first sample of the streams, the following ones
+        // are spaced by the period from it; streams that have not delivered any sample
+        // within the latency from the earliest one are started as invalid
+        bool any = false, all = true;
+        mono_t earliest = 0;
+        for (auto ch = first; ch; ch = ch->next)
+        {
+            if (!ch->count)
+            {
+                all = false;
+                continue;
+            }
+            if (!any || mono_signed_t(ch->Time(0) - earliest) < 0)
+            {
+                earliest = ch->Time(0);
+            }
+            if (!any || mono_signed_t(ch->Time(0) - next) > 0)
+            {
+                next = ch->Time(0);
+            }
+            any = true;
+        }
+        if (!any || (!all && mono_signed_t(now - earliest) < mono_signed_t(latency)))
+        {
+            return false;
+        }
+        started = true;
+    }
+
+    // late streams are held (or reported invalid) once the latency has elapsed
+    bool late = mono_signed_t(now - next) >= mono_signed_t(latency);
+    if (late)
+    {
+        // frames before the first fresh sample of any stream carry no new data, they are skipped
+        // so that a gap in all streams (or a long pause between calls) does not leave a backlog
+        mono_t fresh = now - latency;
+        for (auto ch = first; ch; ch = ch->next)
+        {
+            unsigned n = ch->count;
+            while (n && mono_signed_t(ch->Time(n - 1) - next) > 0)
+            {
+                n--;
+            }
+            if (n < ch->count && mono_signed_t(ch->Time(n) - fresh) < 0)
+            {
+                fresh = ch->Time(n);
+            }
+        }
+        if (mono_signed_t(fresh - next) > mono_signed_t(period))
+        {
+            mono_t n = (fresh - next - 1) / period;
+            next += n * period;
+            skipped += n;
+        }
+    }
+    else
+    {
+        for (auto ch = first; ch; ch = ch->next)
+        {
+            if (!ch->Covers(next))
+            {
+                return false;
+            }
+        }
+    }
+
+    frame.time = next;
+    frame.valid = 0;
+    unsigned i = 0;
+    for (auto ch = first; ch; ch = ch->next, i++)
+    {
+        if (ch->Evaluate(next, values))
+        {
+            frame.valid |= BIT(i);
+        }
+        values += ch->dim;
+        ch->Discard(next);
+    }
+
+    next += period;
+    return true;
+}
+
+}
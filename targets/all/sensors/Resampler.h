@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/Resampler.h
+ *
+ * Combines timestamped sample streams of different rates into fixed-rate,
+ * time-aligned frames, each stream is either interpolated or held (zero-order)
+ *
+ * Frames are emitted once all streams have delivered data past the frame time,
+ * or when the configured latency has elapsed, in which case the late streams
+ * are held at their last value. Late frames in which no stream has a fresh
+ * sample are skipped, so gaps in the data do not accumulate a backlog.
+ * All buffers are statically sized.
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#include <sensors/types.h>
+
+namespace sensors
+{
+
+class Resampler;
+
+//! Timestamped sample stream, the storage is provided by @ref ResamplerChannelT
+class ResamplerChannel
+{
+public:
+    //! Method of evaluating the stream between samples
+    enum struct Mode : uint8_t
+    {
+        //! The last sample at or before the frame time is used
+        Hold,
+        //! Linear interpolation between the samples around the frame time
+        Linear,
+    };
+
+    //! Appends a sample, samples must be pushed in time order, the oldest sample
+    //! is discarded when the buffer is full
+    bool Push(mono_t time, const float* values);
+    //! Appends a sample of a single-value stream
+    bool Push(mono_t time, float value) { ASSERT(dim == 1); return Push(time, &value); }
+    //! Appends a sample of a three-axis stream
+    bool Push(mono_t time, const XYZ& value) { ASSERT(dim == 3); return Push(time, &value.x); }
+
+    //! Gets the number of values in each sample
+    size_t Dimension() const { return dim; }
+    //! Gets the number of buffered samples
+    size_t Count() const { return count; }
+    //! Gets the number of samples discarded because the buffer was full
+    uint32_t Overflows() const { return overflows; }
+
+protected:
+    ResamplerChannel(float* values, mono_t* times, uint8_t dim, uint16_t capacity, Mode mode, mono_t maxAge)
+        : values(values), times(times), maxAge(maxAge), capacity(capacity), dim(dim), mode(mode) {}
+
+private:
+    float* values;
+    mono_t* times;
+    mono_t maxAge;
+    ResamplerChannel* next = NULL;
+    uint32_t overflows = 0;
+    uint16_t capacity, head = 0, count = 0;
+    uint8_t dim;
+    Mode mode;
+
+    uint16_t Index(unsigned i) const { unsigned n = head + i; return n < capacity ? n : n - capacity; }
+    mono_t Time(unsigned i) const { return times[Index(i)]; }
+    const float* Values(unsigned i) const { return values + Index(i) * dim; }
+
+    //! Checks if the stream has a sample at or after @p t
+    bool Covers(mono_t t) const { return count && mono_signed_t(Time(count - 1) - t) >= 0; }
+    //! Evaluates the stream at @p t, returns false (and NaN values) if there is no valid sample
+    bool Evaluate(mono_t t, float* out) const;
+    //! Discards the samples no longer needed to evaluate the stream at @p t or later
+    void Discard(mono_t t);
+
+    friend class Resampler;
+};
+
+//! Sample stream with storage for @p Capacity samples of @p Dim values each
+template<size_t Dim, size_t Capacity> class ResamplerChannelT : public ResamplerChannel
+{
+public:
+    //! Creates the stream
+    //! @param maxAge the stream is reported invalid in frames further than this from
+    //! the last sample, zero disables the check
+    ResamplerChannelT(Mode mode = Mode::Linear, mono_t maxAge = 0)
+        : ResamplerChannel(storage, timestamps, Dim, Capacity, mode, maxAge) {}
+
+private:
+    static_assert(Capacity >= 2 && Capacity <= UINT16_MAX && Dim <= UINT8_MAX);
+
+    float storage[Dim * Capacity];
+    mono_t timestamps[Capacity];
+};
+
+class Resampler
+{
+public:
+    enum
+    {
+        //! Maximum number of streams, limited by the width of @ref Frame::valid
+        MaxChannels = 32,
+    };
+
+    //! Information about an emitted frame
+    struct Frame
+    {
+        //! Time of the frame
+        mono_t time;
+        //! Bit mask of streams with valid values, bit N corresponds to the N-th added stream
+        uint32_t valid;
+    };
+
+    //! Creates a resampler emitting a frame every @p period, waiting at most @p latency
+    //! for late streams; the first frame is at the latest first sample of the streams,
+    //! streams without any sample within @p latency from the earliest one are reported invalid until they deliver
+    Resampler(mono_t period, mono_t latency)
+        : period(period), latency(latency) {}
+
+    //! Adds a stream, its values follow the values of the previously added streams in each frame
+    void Add(ResamplerChannel& channel);
+    //! Gets the total number of values in a frame
+    size_t FrameLength() const { return length; }
+
+    //! Emits the next frame if it is complete or the latency has elapsed at @p now
+    //! @param values receives @ref FrameLength values
+    //! @return true if a frame has been emitted, should be called repeatedly until it returns false
+    bool Next(mono_t now, float* values, Frame& frame);
+    //! Restarts the alignment of frames, e.g. after the streams have been interrupted
+    void Reset() { started = false; }
+    //! Gets the number of late frames skipped because no stream had a fresh sample for them
+    uint32_t Skipped() const { return skipped; }
+
+private:
+    ResamplerChannel* first = NULL;
+    ResamplerChannel** last = &first;
+    mono_t period, latency, next = 0;
+    uint32_t skipped = 0;
+    uint16_t length = 0;
+    uint8_t channels = 0;
+    bool started = false;
+};
+
+}
@@ -26,6 +26,12 @@ protected:
         { return async_forward(SPISensor::ReadRegisterImpl, arg, buf); }
     virtual async(WriteRegisterImpl, Interface::RegAndLength arg, const void* buf) final override
         { return async_forward(SPISensor::WriteRegisterImpl, arg, buf); }
+    virtual async(ReadSequenceImpl, const RegisterRead* seq, size_t count) final override
+        { return async_forward(SPISensor::ReadSequence, seq, count); }
+
+#if SENSOR_STATS
+    virtual SensorStats& Stats() final override { return SPISensor::Stats(); }
+#endif
 
 #if TRACE
     virtual const char* DebugComponent() const final override { return OwnerDebugComponent(); }
@@ -15,15 +15,23 @@ async(SPISensor::ReadRegisterImpl, RegAndLength arg, void* buf)
 async_def(
    bus::SPI::Descriptor tx[2];
    uint8_t hdr;
+#if SENSOR_STATS
+    mono_t start;
+#endif
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadRegisterImpl);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
     f.hdr = arg.reg | hdrRead;
     await(spi.Acquire, cs);
+    SENSOR_STATS_ACQUIRED(f.start);
     f.tx[0].Transmit(f.hdr);
     f.tx[1].Receive(Buffer(buf, arg.length));
     await(spi.Transfer, f.tx);
     spi.Release();
-    async_return(true);
+    async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, true));
 }
 async_end
 
@@ -31,16 +39,146 @@ async(SPISensor::WriteRegisterImpl, RegAndLength arg, const void* buf)
 async_def(
     bus::SPI::Descriptor tx[2];
     uint8_t hdr;
+#if SENSOR_STATS
+    mono_t start;
+#endif
 )
 {
-    f.hdr = arg.reg | hdrWrite;
+    SENSOR_FRAME_FIELDS(FrameSizes::WriteRegisterImpl);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
+    // bit 7 is the read flag, clear it in case the register includes an I2C auto-increment flag
+    f.hdr = (arg.reg & 0x7F) | hdrWrite;
     await(spi.Acquire, cs);
+    SENSOR_STATS_ACQUIRED(f.start);
     f.tx[0].Transmit(f.hdr);
     f.tx[1].Transmit(Span(buf, arg.length));
     await(spi.Transfer, f.tx);
     spi.Release();
+    async_return(SENSOR_STATS_TRANSFER(f.start, arg.length, true));
+}
+async_end
+
+async(SPISensor::UpdateRegistersImpl, RegisterBursts bursts)
+async_def(
+    RegisterBursts bursts;
+    RegisterBursts::Burst burst;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::UpdateRegisters);
+    f.bursts = bursts;
+    while ((f.burst = f.bursts.Next()))
+    {
+        MYTRACE("Updating registers %02X-%02X", f.bursts.Register(f.burst), f.bursts.Register(f.burst) + f.burst.length - 1);
+        if (!await(WriteRegisterImpl, RegAndLength(f.bursts.Register(f.burst), f.burst.length), f.bursts.Desired(f.burst)))
+        {
+            async_return(false);
+        }
+        f.bursts.Commit(f.burst);
+    }
+
+    async_return(true);
+}
+async_end
+
+async(SPISensor::ReadCachedImpl, RegAndLength arg, void* buf, RegisterShadow shadow)
+async_def(
+    RegisterShadow shadow;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadCached);
+    if (shadow.Read(arg.reg, buf, arg.length))
+    {
+        async_return(true);
+    }
+
+    f.shadow = shadow;
+    if (!await(ReadRegisterImpl, arg, buf))
+    {
+        async_return(false);
+    }
+
+    f.shadow.Store(arg.reg, buf, arg.length);
     async_return(true);
 }
 async_end
 
+async(SPISensor::WriteSequence, const RegisterWrite* seq, size_t count)
+async_def(
+    size_t i;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::WriteSequence);
+    for (f.i = 0; f.i < count; f.i++)
+    {
+        if (!await(WriteRegisterImpl, RegAndLength(seq[f.i].reg, seq[f.i].length), seq[f.i].data))
+        {
+            async_return(false);
+        }
+    }
+
+    async_return(true);
+}
+async_end
+
+async(SPISensor::ReadSequence, const RegisterRead* seq, size_t count)
+async_def(
+    bus::SPI::Descriptor tx[2];
+    uint8_t hdr;
+    size_t i, next;
+#if SENSOR_STATS
+    mono_t start;
+#endif
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadSequence);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
+    await(spi.Acquire, cs);
+    SENSOR_STATS_ACQUIRED(f.start);
+    for (f.i = 0; f.i < count; f.i = f.next)
+    {
+        size_t len = seq[f.i].length;
+        for (f.next = f.i + 1; f.next < count; f.next++)
+        {
+            auto& r = seq[f.next];
+            if ((r.reg & 0x7F) != (seq[f.i].reg & 0x7F) + len || r.data != (uint8_t*)seq[f.i].data + len)
+            {
+                break;
+            }
+            len += r.length;
+        }
+
+        f.hdr = seq[f.i].reg | hdrRead;
+        f.tx[0].Transmit(f.hdr);
+        f.tx[1].Receive(Buffer(seq[f.i].data, len));
+        await(spi.Transfer, f.tx);
+    }
+    spi.Release();
+#if SENSOR_STATS
+    // the whole sequence is accounted as a single transfer, as it is a single bus acquisition
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += seq[i].length;
+    }
+    SENSOR_STATS_TRANSFER(f.start, total, true);
+#endif
+    async_return(true);
+}
+async_end
+
+#ifndef SENSOR_FRAME_BUDGET_SPISensor
+#define SENSOR_FRAME_BUDGET_SPISensor    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(SPISensor, ReadRegisterImpl, SPISensor::FrameSizes::ReadRegisterImpl);
+SENSOR_FRAME_CHECK(SPISensor, WriteRegisterImpl, SPISensor::FrameSizes::WriteRegisterImpl);
+SENSOR_FRAME_CHECK(SPISensor, UpdateRegisters, SPISensor::FrameSizes::UpdateRegisters);
+SENSOR_FRAME_CHECK(SPISensor, ReadCached, SPISensor::FrameSizes::ReadCached);
+SENSOR_FRAME_CHECK(SPISensor, ReadSequence, SPISensor::FrameSizes::ReadSequence);
+SENSOR_FRAME_CHECK(SPISensor, WriteSequence, SPISensor::FrameSizes::WriteSequence);
+
 }
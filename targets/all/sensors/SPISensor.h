@@ -13,7 +13,11 @@
 #include <base/Span.h>
 #include <bus/SPI.h>
 
+#include "FrameBudget.h"
 #include "Interface.h"
+#include "RegisterBursts.h"
+#include "RegisterMap.h"
+#include "SensorStats.h"
 
 namespace sensors
 {
@@ -33,6 +37,31 @@ protected:
     template<typename T> async(ReadRegister, T reg, Buffer buf) { return async_forward(ReadRegisterImpl, RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer()); }
     //! Writes data to consecutive registers (register address is written as the first byte)
     template<typename T> async(WriteRegister, T reg, Span buf) { return async_forward(WriteRegisterImpl, RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer()); }
+    //! Writes only the registers of a block that differ between the shadow copy @p actual and @p desired,
+    //! in as few bursts as possible, updating the shadow copy as the bursts are written
+    //! @param volatileMask bit mask of registers that are never compared nor written, see @ref RegisterBursts
+    template<typename TReg, typename T> async(UpdateRegisters, TReg reg, T& actual, const T& desired, uint32_t volatileMask = 0) { return async_forward(UpdateRegistersImpl, RegisterBursts(uint8_t(reg), actual, desired, volatileMask)); }
+    //! Reads data from registers of a block kept in the shadow copy @p actual, non-volatile registers
+    //! are served from the shadow copy without any bus traffic, see @ref RegisterShadow
+    template<typename TReg, typename T> async(ReadCached, TReg reg, Buffer buf, TReg block, T& actual, uint32_t volatileMask = 0) { return async_forward(ReadCachedImpl, RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer(), RegisterShadow(uint8_t(block), actual, volatileMask)); }
+    //! Reads a sequence of register blocks, stopping at the first failure
+    //! The whole sequence is read during a single bus acquisition, blocks of consecutive registers
+    //! read into consecutive memory are merged into a single transfer
+    //! Grouping is limited to this device, bus::SPI binds the chip select when the bus is acquired,
+    //! so transfers of several devices cannot be chained into a single acquisition
+    async(ReadSequence, const RegisterRead* seq, size_t count);
+    //! Reads a sequence of register blocks, stopping at the first failure
+    template<size_t n> async(ReadSequence, const RegisterRead (&seq)[n]) { return async_forward(ReadSequence, seq, n); }
+    //! Writes a sequence of register bursts, stopping at the first failure
+    async(WriteSequence, const RegisterWrite* seq, size_t count);
+    //! Writes a sequence of register bursts, stopping at the first failure
+    template<size_t n> async(WriteSequence, const RegisterWrite (&seq)[n]) { return async_forward(WriteSequence, seq, n); }
+
+#if SENSOR_STATS
+    //! Gets the performance counters
+    const SensorStats& Statistics() const { return stats; }
+    SensorStats& Stats() { return stats; }
+#endif
 
 #if TRACE
     virtual const char* DebugComponent() const { return "SPISensor"; }
@@ -52,6 +81,9 @@ private:
     bus::SPI spi;
     bus::SPI::ChipSelect cs;
     uint8_t hdrRead, hdrWrite;
+#if SENSOR_STATS
+    SensorStats stats = {};
+#endif
 #if TRACE
     GPIOPin pin;
 #endif
@@ -60,6 +92,28 @@ private:
 
     async(ReadRegisterImpl, RegAndLength arg, void* buf);
     async(WriteRegisterImpl, RegAndLength arg, const void* buf);
+    async(UpdateRegistersImpl, RegisterBursts bursts);
+    async(ReadCachedImpl, RegAndLength arg, void* buf, RegisterShadow shadow);
+
+public:
+    //! Worst-case size of the async frames of a bus operation, see @ref FrameBudget.h
+    static constexpr size_t BusFrameSize = SENSOR_FRAME_BUS;                  // Acquire, Transfer
+
+    //! Worst-case sizes of the nested async frames
+    struct FrameSizes
+    {
+        static constexpr FrameEntry ReadRegisterImpl = { FrameSize<bus::SPI::Descriptor[2], uint8_t, FrameStatsStart>, BusFrameSize };
+        static constexpr FrameEntry WriteRegisterImpl = { FrameSize<bus::SPI::Descriptor[2], uint8_t, FrameStatsStart>, BusFrameSize };
+        static constexpr FrameEntry UpdateRegisters = { FrameSize<RegisterBursts, RegisterBursts::Burst>, WriteRegisterImpl };
+        static constexpr FrameEntry ReadCached = { FrameSize<RegisterShadow>, ReadRegisterImpl };
+        static constexpr FrameEntry ReadSequence = { FrameSize<bus::SPI::Descriptor[2], uint8_t, size_t, size_t, FrameStatsStart>, BusFrameSize };
+        static constexpr FrameEntry WriteSequence = { FrameSize<size_t>, WriteRegisterImpl };
+    };
+
+    //! Worst-case size of the async frames of a single register transfer
+    static constexpr size_t TransferFrameSize = FrameMax(FrameSizes::ReadRegisterImpl, FrameSizes::WriteRegisterImpl);
+    //! Worst-case size of the nested async frames of any register operation
+    static constexpr size_t RegisterFrameSize = FrameMax(FrameSizes::UpdateRegisters, FrameSizes::ReadCached, FrameSizes::ReadSequence, FrameSizes::WriteSequence);
 
     friend class SPIInterface;
 };
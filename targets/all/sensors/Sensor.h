@@ -12,30 +12,26 @@
 
 #include "I2CInterface.h"
 #include "SPIInterface.h"
+#include "ReplayInterface.h"
+#include "StaticSensor.h"
 
 namespace sensors
 {
 
 #if SENSORS_NO_I2C
 
-class Sensor : protected SPISensor
+class Sensor : protected StaticSensor<SPISensor>
 {
 protected:
-    Sensor(bus::SPI spi, GPIOPin cs, uint8_t hdrRead, uint8_t hdrWrite)
-        : SPISensor(spi, cs, hdrRead, hdrWrite) { }
-    Sensor(bus::I2C i2c, uint8_t address)
-        : SPISensor(NULL, Px, 0, 0) { ASSERT(false); }
+    using StaticSensor::StaticSensor;
 };
 
 #elif SENSORS_NO_SPI
 
-class Sensor : protected I2CSensor
+class Sensor : protected StaticSensor<I2CSensor>
 {
 protected:
-    Sensor(bus::SPI spi, GPIOPin cs, uint8_t hdrRead, uint8_t hdrWrite)
-        : I2CSensor(null, 0) { ASSERT(false); }
-    Sensor(bus::I2C i2c, uint8_t address)
-        : I2CSensor(i2c, address) { }
+    using StaticSensor::StaticSensor;
 };
 
 #else
@@ -53,11 +49,40 @@ protected:
         : interface(*new(MemPoolAlloc<I2CInterface>()) I2CInterface(i2c, address)) { InitTrace(); }
     Sensor(bus::SPI spi, GPIOPin cs, uint8_t hdrRead, uint8_t hdrWrite)
         : interface(*new(MemPoolAlloc<SPIInterface>()) SPIInterface(spi, cs, hdrRead, hdrWrite)) { InitTrace(); }
+    //! Creates a sensor communicating through an externally owned interface, e.g. a @ref ReplayInterface
+    Sensor(Interface& interface)
+        : interface(interface) { InitTrace(); }
 
     //! Reads data from consecutive registers (register address is written before changing direction)
-    template<typename T> async(ReadRegister, T reg, Buffer buf) { return async_forward(interface.ReadRegisterImpl, Interface::RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer()); }
+    template<typename T> async(ReadRegister, T reg, Buffer buf) { return async_forward(interface.ReadRegister, Interface::RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer()); }
     //! Writes data to consecutive registers (register address is written as the first byte)
-    template<typename T> async(WriteRegister, T reg, Span buf) { return async_forward(interface.WriteRegisterImpl, Interface::RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer()); }
+    template<typename T> async(WriteRegister, T reg, Span buf) { return async_forward(interface.WriteRegister, Interface::RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer()); }
+    //! Reads a sequence of register blocks, stopping at the first failure
+    async(ReadSequence, const RegisterRead* seq, size_t count) { return async_forward(interface.ReadSequence, seq, count); }
+    //! Reads a sequence of register blocks, stopping at the first failure
+    template<size_t n> async(ReadSequence, const RegisterRead (&seq)[n]) { return async_forward(ReadSequence, seq, n); }
+    //! Writes only the registers of a block that differ between the shadow copy @p actual and @p desired,
+    //! in as few bursts as possible, updating the shadow copy as the bursts are written
+    //! @param volatileMask bit mask of registers that are never compared nor written, see @ref RegisterBursts
+    template<typename TReg, typename T> async(UpdateRegisters, TReg reg, T& actual, const T& desired, uint32_t volatileMask = 0) { return async_forward(interface.UpdateRegisters, RegisterBursts(uint8_t(reg), actual, desired, volatileMask)); }
+    //! Reads data from registers of a block kept in the shadow copy @p actual, non-volatile registers
+    //! are served from the shadow copy without any bus traffic, see @ref RegisterShadow
+    template<typename TReg, typename T> async(ReadCached, TReg reg, Buffer buf, TReg block, T& actual, uint32_t volatileMask = 0) { return async_forward(interface.ReadCached, Interface::RegAndLength(uint8_t(reg), buf.Length()), buf.Pointer(), RegisterShadow(uint8_t(block), actual, volatileMask)); }
+    //! Writes a sequence of register bursts, stopping at the first failure
+    async(WriteSequence, const RegisterWrite* seq, size_t count) { return async_forward(interface.WriteSequence, seq, count); }
+    //! Writes a sequence of register bursts, stopping at the first failure
+    template<size_t n> async(WriteSequence, const RegisterWrite (&seq)[n]) { return async_forward(WriteSequence, seq, n); }
+
+#if SENSOR_RECORD
+    //! Logs all following register transactions into @p recorder under the specified @p device identifier
+    void Record(BusRecorder* recorder, uint8_t device) { interface.Record(recorder, device); }
+#endif
+
+#if SENSOR_STATS
+    //! Gets the performance counters
+    const SensorStats& Statistics() const { return interface.Stats(); }
+    SensorStats& Stats() { return interface.Stats(); }
+#endif
 
 #if TRACE
     virtual const char* DebugComponent() const { return "Sensor"; }
@@ -72,6 +97,16 @@ protected:
     template<typename... Args> void MYTRACE(Args...) {}
 #endif
 
+public:
+    //! Worst-case size of the async frames of a single transfer of any @ref Interface implementation
+    static constexpr size_t InterfaceFrameSize = FrameMax(I2CSensor::TransferFrameSize, SPISensor::TransferFrameSize,
+        SPISensor::FrameSizes::ReadSequence, ReplayInterface::FrameSizes::ReadRegisterImpl);
+    //! Worst-case sizes of the nested async frames of the @ref Interface operations
+    using InterfaceFrameSizes = Interface::FrameSizes<InterfaceFrameSize>;
+    //! Worst-case size of the nested async frames of any register operation, see @ref FrameBudget.h
+    static constexpr size_t RegisterFrameSize = FrameMax(InterfaceFrameSizes::UpdateRegisters, InterfaceFrameSizes::ReadCached,
+        InterfaceFrameSizes::ReadSequence, InterfaceFrameSizes::WriteSequence);
+
 private:
     Interface& interface;
 
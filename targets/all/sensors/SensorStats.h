@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/SensorStats.h
+ *
+ * Optional performance counters collected by sensor transports and drivers,
+ * enabled by compiling with SENSOR_STATS
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+namespace sensors
+{
+
+//! Histogram with power-of-two buckets, bucket N counts values in range [2^(N-1), 2^N)
+struct Log2Histogram
+{
+    enum
+    {
+        Buckets = 16,
+    };
+
+    uint32_t bucket[Buckets];
+
+    void Add(uint32_t value)
+    {
+        unsigned i = value ? 32 - __builtin_clz(value) : 0;
+        bucket[i < Buckets ? i : Buckets - 1]++;
+    }
+};
+
+//! Performance counters of a single sensor
+struct SensorStats
+{
+    //! Number of register transfers
+    uint32_t transfers;
+    //! Number of register transfers that failed (e.g. NAK)
+    uint32_t failures;
+    //! Number of bytes transferred successfully, excluding register addresses
+    uint32_t bytes;
+    //! Number of driver (re)initializations
+    uint32_t inits;
+    //! Number of FIFO overruns detected
+    uint32_t overruns;
+    //! Number of samples known to be lost
+    uint32_t dropped;
+    //! Number of failed transactions that succeeded when retried
+    uint32_t retries;
+    //! Number of recoveries where the device was found intact by reading back its configuration
+    uint32_t verified;
+    //! Number of recoveries where the configuration was rewritten without a reset
+    uint32_t restored;
+    //! Number of recoveries that required a full reset and reinitialization
+    uint32_t resets;
+    //! Duration of register transfers, in microseconds, waiting for the bus is excluded
+    //! where the transport acquires it separately (SPI), I2C transfers acquire it internally
+    Log2Histogram transferTime;
+    //! Time spent waiting for the bus to be acquired before register transfers, in microseconds
+    Log2Histogram waitTime;
+    //! Duration of successful measurements, in microseconds
+    Log2Histogram measureTime;
+
+    //! Records a completed register transfer, returns @p success
+    bool Transfer(mono_t start, size_t length, bool success)
+    {
+        transfers++;
+        if (success) { bytes += length; } else { failures++; }
+        transferTime.Add(MonoToMicroseconds(MONO_CLOCKS - start));
+        return success;
+    }
+
+    //! Records the time spent waiting for the bus, returns the start of the transfer itself
+    mono_t Acquired(mono_t start)
+    {
+        mono_t now = MONO_CLOCKS;
+        waitTime.Add(MonoToMicroseconds(now - start));
+        return now;
+    }
+
+    //! Records a completed measurement
+    void Measure(mono_t start) { measureTime.Add(MonoToMicroseconds(MONO_CLOCKS - start)); }
+};
+
+}
+
+#if SENSOR_STATS
+//! Records the result of a register transfer started at @p start
+#define SENSOR_STATS_TRANSFER(start, length, success)   Stats().Transfer((start), (length), (success))
+//! Records the bus wait of a transfer started at @p start and moves @p start past it
+#define SENSOR_STATS_ACQUIRED(start)                    ((start) = Stats().Acquired(start))
+//! Updates a driver counter
+#define SENSOR_STATS_COUNT(counter)                     (Stats().counter++)
+//! Adds to a driver counter
+#define SENSOR_STATS_ADD(counter, n)                    (Stats().counter += (n))
+//! Records the duration of a measurement started at @p start
+#define SENSOR_STATS_MEASURE(start)                     Stats().Measure(start)
+#else
+#define SENSOR_STATS_TRANSFER(start, length, success)   (success)
+#define SENSOR_STATS_ACQUIRED(start)
+#define SENSOR_STATS_COUNT(counter)
+#define SENSOR_STATS_ADD(counter, n)
+#define SENSOR_STATS_MEASURE(start)
+#endif
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/StaticSensor.h
+ *
+ * Sensor base with the bus selected at compile time
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#include "I2CSensor.h"
+#include "SPISensor.h"
+
+namespace sensors
+{
+
+//! Drop-in replacement for @ref Sensor with the transport fixed at compile time,
+//! register access is dispatched directly to @p TTransport instead of through
+//! a pool-allocated @ref Interface
+//!
+//! Drivers templated on their base accept it in place of @ref Sensor, e.g. LPS22HBT<StaticSensor<I2CSensor>>.
+//! Constructing it for the other bus fails an assertion, like @ref Sensor does
+//! when one of the buses is disabled using SENSORS_NO_I2C or SENSORS_NO_SPI
+template<class TTransport> class StaticSensor;
+
+template<> class StaticSensor<I2CSensor> : protected I2CSensor
+{
+protected:
+    StaticSensor(bus::I2C i2c, uint8_t address)
+        : I2CSensor(i2c, address) { }
+    StaticSensor(bus::SPI spi, GPIOPin cs, uint8_t hdrRead, uint8_t hdrWrite)
+        : I2CSensor(null, 0) { ASSERT(false); }
+};
+
+template<> class StaticSensor<SPISensor> : protected SPISensor
+{
+protected:
+    StaticSensor(bus::SPI spi, GPIOPin cs, uint8_t hdrRead, uint8_t hdrWrite)
+        : SPISensor(spi, cs, hdrRead, hdrWrite) { }
+    StaticSensor(bus::I2C i2c, uint8_t address)
+        : SPISensor(NULL, Px, 0, 0) { ASSERT(false); }
+};
+
+}
@@ -17,6 +17,7 @@ async_def(
     FDCConfig fdcConf;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     init = false;
     if (!await(ReadRegister, Register::DEVICE_ID, f.value, true))
     {
@@ -63,6 +64,7 @@ async_def(
     uint16_t cfg;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Configure);
     ASSERT(channel < countof(value));
 
     f.cfg = swap16(cfg);
@@ -81,6 +83,7 @@ async_def(
     uint16_t offset, gain;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::SetCalibration);
     f.offset = swap16(arg.offset);
     f.gain = swap16(arg.gain);
     async_return(
@@ -95,6 +98,7 @@ async_def(
     FDCConfig config;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Start);
     f.config = swap16(config);
     async_return(await(WriteRegister, Register::FDC_CONF, f.config));
 }
@@ -106,6 +110,7 @@ async_def(
     FDCConfig config;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Wait);
     f.timeout = timeout.MakeAbsolute();
 
     do
@@ -140,6 +145,7 @@ async_def(
     };
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
     if ((f.updated = await(Wait, timeout)))
     {
         for (f.i = 0; f.i < countof(value); f.i++)
@@ -163,4 +169,15 @@ async_def(
 }
 async_end
 
+#ifndef SENSOR_FRAME_BUDGET_FDC1004
+#define SENSOR_FRAME_BUDGET_FDC1004    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(FDC1004, Init, FDC1004::FrameSizes::Init);
+SENSOR_FRAME_CHECK(FDC1004, Configure, FDC1004::FrameSizes::Configure);
+SENSOR_FRAME_CHECK(FDC1004, SetCalibration, FDC1004::FrameSizes::SetCalibration);
+SENSOR_FRAME_CHECK(FDC1004, Start, FDC1004::FrameSizes::Start);
+SENSOR_FRAME_CHECK(FDC1004, Wait, FDC1004::FrameSizes::Wait);
+SENSOR_FRAME_CHECK(FDC1004, Measure, FDC1004::FrameSizes::Measure);
+
 }
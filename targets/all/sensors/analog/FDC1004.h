@@ -156,6 +156,18 @@ private:
     float value[ChannelCount] = { NAN, NAN, NAN, NAN };
 
     template<typename T> static constexpr T swap16(T val) { return (T)FROM_BE16((uint16_t)val); }
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Init = { FrameSize<uint16_t, FDCConfig>, RegisterFrameSize };
+        static constexpr FrameEntry Configure = { FrameSize<uint16_t>, RegisterFrameSize };
+        static constexpr FrameEntry SetCalibration = { FrameSize<uint16_t, uint16_t>, RegisterFrameSize };
+        static constexpr FrameEntry Start = { FrameSize<FDCConfig>, RegisterFrameSize };
+        static constexpr FrameEntry Wait = { FrameSize<Timeout, FDCConfig>, RegisterFrameSize };
+        static constexpr FrameEntry Measure = { FrameSize<unsigned, unsigned, int32_t>, FrameMax(Wait, RegisterFrameSize) };
+    };
 };
 
 DEFINE_FLAG_ENUM(FDC1004::FDCConfig);
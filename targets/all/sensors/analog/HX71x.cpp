@@ -27,6 +27,7 @@ static ALWAYS_INLINE void clkdelay()
 async(HX71x::Init, MeasurementType type)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     this->type = type ? type : MeasurementType::Default;
 
     sck.ConfigureDigitalOutput(false);
@@ -50,6 +51,7 @@ async_end
 async(HX71x::Measure, MeasurementType nextType)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
     if (sck)
     {
         // power on, but make sure it is really powered down if it was done just a while ago
@@ -108,4 +110,11 @@ async_def_sync()
 }
 async_end
 
+#ifndef SENSOR_FRAME_BUDGET_HX71x
+#define SENSOR_FRAME_BUDGET_HX71x    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(HX71x, Init, HX71x::FrameSizes::Init);
+SENSOR_FRAME_CHECK(HX71x, Measure, HX71x::FrameSizes::Measure);
+
 }
@@ -12,6 +12,8 @@
 
 #include <hw/GPIO.h>
 
+#include <sensors/FrameBudget.h>
+
 namespace sensors::analog
 {
 
@@ -62,6 +64,14 @@ private:
     MeasurementType type;
     mono_t powerDownAt;
     float value = NAN;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Init = { FrameSize<>, SENSOR_FRAME_BUS };      // GPIOPin::WaitFor
+        static constexpr FrameEntry Measure = { FrameSize<>, SENSOR_FRAME_BUS };   // GPIOPin::WaitFor
+    };
 };
 
 }
@@ -14,6 +14,7 @@ namespace sensors::environment
 async(CCS811::SetMode, DriveMode mode)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::SetMode);
     if (this->mode != mode)
     {
         this->mode = mode;
@@ -34,6 +35,7 @@ async_end
 async(CCS811::Init)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     MYDBG("Resetting...");
     async_yield();
     wakeCount++;
@@ -113,8 +115,9 @@ done:
 async_end
 
 async(CCS811::Measure)
-async_def(bool success; int i)
+async_def(bool success; bool read; int i)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
     if (init || await(Init))
     {
         await(Wake);
@@ -157,9 +160,20 @@ async_def(bool success; int i)
                 await(WriteRegister, Register::Mode, msg.mode);
             }
         }
-        else if (await(ReadRegister, Register::Result, msg.result))
+        else
         {
-            if (msg.result.status.error)
+            f.read = await(ReadRegister, Register::Result, msg.result);
+            if (!f.read && (f.read = await(ReadRegister, Register::Result, msg.result)))
+            {
+                // a single glitch on the bus, the repeated transaction succeeded
+                SENSOR_STATS_COUNT(retries);
+            }
+
+            if (!f.read)
+            {
+                MYDBG("Failed to read result");
+            }
+            else if (msg.result.status.error)
             {
                 MYDBG("ERROR %d", msg.result.error);
             }
@@ -179,10 +193,14 @@ async_def(bool success; int i)
     if (!f.success)
     {
         MYDBG("Measurement FAILED");
-        init = false;
         co2 = tvoc = NAN;
         raw = ~0;
-        envSet = { ~0u };
+        if (init && !await(Recover))
+        {
+            // the reset loses the environment data as well
+            init = false;
+            envSet = { ~0u };
+        }
     }
 
     await(Sleep);
@@ -199,9 +217,42 @@ void CCS811::RequestUpdate()
     }
 }
 
+async(CCS811::Recover)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::Recover);
+    if (await(ReadRegister, Register::Status, msg.status) && msg.status.appRunning && !msg.status.error &&
+        await(ReadRegister, Register::Mode, msg.mode))
+    {
+        if (msg.mode.driveMode == (uint8_t)mode)
+        {
+            MYDBG("Recovered, configuration intact");
+            SENSOR_STATS_COUNT(verified);
+            async_return(true);
+        }
+
+        // the application is running, only the drive mode needs to be restored, a reset
+        // would lose the baseline and restart the conditioning period
+        MYDBG("Restoring mode %d", mode);
+        msg.mode.raw = 0;
+        msg.mode.driveMode = (uint8_t)mode;
+        if (await(WriteRegister, Register::Mode, msg.mode))
+        {
+            SENSOR_STATS_COUNT(restored);
+            async_return(true);
+        }
+    }
+
+    MYDBG("Recovery failed, resetting");
+    SENSOR_STATS_COUNT(resets);
+    async_return(false);
+}
+async_end
+
 async(CCS811::Wake)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Wake);
     if (!wakeCount++)
     {
         wake.Res();
@@ -227,6 +278,7 @@ async_def(
     bool wake;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Update);
     while (envSet.raw != envCfg.raw)
     {
         if (!f.wake)
@@ -252,5 +304,14 @@ async_def(
 }
 async_end
 
+#ifndef SENSOR_FRAME_BUDGET_CCS811
+#define SENSOR_FRAME_BUDGET_CCS811    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(CCS811, SetMode, CCS811::FrameSizes::SetMode);
+SENSOR_FRAME_CHECK(CCS811, Init, CCS811::FrameSizes::Init);
+SENSOR_FRAME_CHECK(CCS811, Measure, CCS811::FrameSizes::Measure);
+SENSOR_FRAME_CHECK(CCS811, Update, CCS811::FrameSizes::Update);
+
 }
 
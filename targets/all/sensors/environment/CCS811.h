@@ -82,6 +82,9 @@ private:
     async(Wake);
     async(Sleep);
     async(Update);
+    //! Verifies the device state after a failed measurement, restoring the drive mode
+    //! if possible, returns false if a full reset is required
+    async(Recover);
 
     enum struct Register : uint8_t
     {
@@ -272,6 +275,18 @@ private:
         AppEraseKey appErase;
         AppVerifyKey appVerify;
     } msg;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Wake = { FrameSize<>, 0 };
+        static constexpr FrameEntry SetMode = { FrameSize<>, FrameMax(Wake, RegisterFrameSize) };
+        static constexpr FrameEntry Init = { FrameSize<>, RegisterFrameSize };
+        static constexpr FrameEntry Recover = { FrameSize<>, RegisterFrameSize };
+        static constexpr FrameEntry Measure = { FrameSize<bool, bool, int>, FrameMax(Init, Wake, Recover, RegisterFrameSize) };
+        static constexpr FrameEntry Update = { FrameSize<EnvData, bool>, FrameMax(Wake, RegisterFrameSize) };
+    };
 };
 
 }
@@ -11,9 +11,10 @@
 namespace sensors::environment
 {
 
-async(LPS22HB::InitImpl, InitConfig cfg)
+template<class TSensor> async(LPS22HBT<TSensor>::InitImpl, InitConfig cfg)
 async_def(uint8_t id)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::InitImpl);
     MYDBG("Reading ID...");
 
     if (!await(ReadRegister, Register::ID, f.id))
@@ -37,19 +38,29 @@ async_def(uint8_t id)
 
     this->cfg = cfg;
     MYDBG("Init complete, ID: %02X, CTL1: %02X, CTL2: %02X, FIFO: %02X", f.id, cfg.ctl1, cfg.ctl2, cfg.fifo);
+    SENSOR_STATS_COUNT(inits);
     async_return(init = true);
 }
 async_end
 
-async(LPS22HB::Measure)
-async_def(PACKED_UNALIGNED_STRUCT { Status status; Sample smp; } data;)
+template<class TSensor> async(LPS22HBT<TSensor>::Measure)
+async_def(
+    PACKED_UNALIGNED_STRUCT { Status status; Sample smp; } data;
+#if SENSOR_STATS
+    mono_t start;
+#endif
+)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
     if (!init && !await(Init))
     {
         async_return(false);
     }
 
-    if (Rate() == Control1::RateOneShot)
+    if (CurrentRate() == Control1::RateOneShot)
     {
         if (!await(Trigger) || !await(WaitForData, Timeout::Seconds(1)))
         {
@@ -72,38 +83,46 @@ async_def(PACKED_UNALIGNED_STRUCT { Status status; Sample smp; } data;)
     pressure = f.data.smp.Pressure();
     temperature = f.data.smp.Temperature();
     MYDBG("new data: P=%.3q, T=%.2q", int(pressure * 1000), int(temperature * 100));
+    SENSOR_STATS_MEASURE(f.start);
     async_return(true);
 }
 async_end
 
-async(LPS22HB::Trigger)
+template<class TSensor> async(LPS22HBT<TSensor>::Trigger)
 async_def(Control2 ctl2)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Trigger);
     f.ctl2 = cfg.ctl2 | Control2::Trigger;
     async_return(await(WriteRegister, Register::Control2, f.ctl2));
 }
 async_end
 
-async(LPS22HB::DataReady)
+template<class TSensor> async(LPS22HBT<TSensor>::DataReady)
 async_def(
     FifoStatus stat;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::DataReady);
     async_return(await(ReadRegister, Register::FifoStatus, f.stat) ? f.stat.count : 0);
 }
 async_end
 
-async(LPS22HB::ReadFifo, Sample* buffer, size_t count)
+template<class TSensor> async(LPS22HBT<TSensor>::ReadFifo, Sample* buffer, size_t count)
 async_def(
     FifoStatus stat;
     size_t count;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadFifo);
     if (count == 0 || !await(ReadRegister, Register::FifoStatus, f.stat) || f.stat.count == 0)
     {
         async_return(0);
     }
 
+    if (f.stat.overrun)
+    {
+        SENSOR_STATS_COUNT(overruns);
+    }
     f.count = std::min(count, (size_t)f.stat.count);
     if (!await(ReadRegister, Register::Data, Buffer(buffer, f.count * sizeof(Sample))))
     {
@@ -114,11 +133,12 @@ async_def(
 }
 async_end
 
-async(LPS22HB::WaitForData, Timeout timeout)
+template<class TSensor> async(LPS22HBT<TSensor>::WaitForData, Timeout timeout)
 async_def(
     Timeout timeout;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::WaitForData);
     f.timeout = timeout.MakeAbsolute();
 
     while (!await(DataReady))
@@ -135,4 +155,18 @@ async_def(
 }
 async_end
 
+template class LPS22HBT<Sensor>;
+#if !SENSORS_NO_I2C && !SENSORS_NO_SPI
+template class LPS22HBT<StaticSensor<I2CSensor>>;
+template class LPS22HBT<StaticSensor<SPISensor>>;
+#endif
+
+#ifndef SENSOR_FRAME_BUDGET_LPS22HB
+#define SENSOR_FRAME_BUDGET_LPS22HB    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(LPS22HB, InitImpl, LPS22HB::FrameSizes::InitImpl);
+SENSOR_FRAME_CHECK(LPS22HB, Measure, LPS22HB::FrameSizes::Measure);
+SENSOR_FRAME_CHECK(LPS22HB, ReadFifo, LPS22HB::FrameSizes::ReadFifo);
+
 }
@@ -11,11 +11,13 @@
 #pragma once
 
 #include <sensors/Sensor.h>
+#include <sensors/StaticSensor.h>
 
 namespace sensors::environment
 {
 
-class LPS22HB : Sensor
+//! Definitions shared by all @ref LPS22HBT variants
+class LPS22HBBase
 {
 public:
     enum struct Address : uint8_t
@@ -31,17 +33,14 @@ public:
 
         float Pressure() const { return FROM_LE24(pressureLE) * (1.0f / 4096); }
         float Temperature() const { return FROM_LE16(tempLE) * 0.01f; }
+
+        //! Interprets data read through a sensor hub (e.g. @ref LSM6DSO::FifoSample::HubData)
+        static Sample FromHub(Span data) { Sample smp; memcpy(&smp, data.Pointer(), sizeof(smp)); return smp; }
     };
 
-    LPS22HB(bus::I2C i2c, Address address)
-        : Sensor(i2c, (uint8_t)address)
-    {
-    }
-
-    LPS22HB(bus::SPI spi, GPIOPin cs)
-        : Sensor(spi, cs, 0x80, 0x00)
-    {
-    }
+    //! First output register and length for polling the sensor through a sensor hub (e.g. @ref LSM6DSO::HubSlave),
+    //! PRESS_OUT_XL to TEMP_OUT_H, relying on the default IF_ADD_INC
+    static constexpr uint8_t HubOutputRegister = 0x28, HubOutputLength = sizeof(Sample);
 
     enum Rate
     {
@@ -60,27 +59,7 @@ public:
         FilterStrong = 0xC,
     };
 
-    //! Initializes the sensor
-    async(Init, Rate rate = RateOneShot, Filter filter = FilterOff) { return async_forward(InitImpl, InitConfig(rate | filter, Control2::FifoEnable | Control2::AutoAddrIncrement, FifoControl::ModeDynamicStream)); }
-    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
-    //! If current rate is @ref Control2::RateOneShot, a measurement is triggered and result is retrieved
-    async(Measure);
-    //! Retrieves fifo contents
-    template<size_t n> async(ReadFifo, Sample (&buffer)[n]) { return async_forward(ReadFifo, buffer, n); }
-    //! Retrieves fifo contents
-    async(ReadFifo, Sample* buffer, size_t count);
-
-    //! Checks if the sensor is initialized
-    bool Initialized() const { return init; }
-    //! Gets the last measured pressure in hPa; NaN if not available
-    float GetPressure() const { return pressure; }
-    //! Gets the last measured temperature in degrees celsius; NaN if not available
-    float GetTemperature() const { return temperature; }
-
 protected:
-    const char* DebugComponent() const { return "LPS22HB"; }
-
-private:
     enum struct Register : uint8_t
     {
         ID = 0x0F,
@@ -162,11 +141,9 @@ private:
         TemperatureOverrun = 0x20,
     };
 
-    DECLARE_FLAG_ENUM(LPS22HB::Control1);
-    DECLARE_FLAG_ENUM(LPS22HB::Control2);
-    DECLARE_FLAG_ENUM(LPS22HB::Status);
-
-    Control1 Rate() const { return cfg.ctl1 & Control1::RateMask; }
+    DECLARE_FLAG_ENUM(LPS22HBBase::Control1);
+    DECLARE_FLAG_ENUM(LPS22HBBase::Control2);
+    DECLARE_FLAG_ENUM(LPS22HBBase::Status);
 
     union InitConfig
     {
@@ -183,6 +160,62 @@ private:
             FifoControl fifo;
         };
     };
+};
+
+DEFINE_FLAG_ENUM(LPS22HBBase::Control1);
+DEFINE_FLAG_ENUM(LPS22HBBase::Control2);
+DEFINE_FLAG_ENUM(LPS22HBBase::Status);
+
+//! Driver for the LPS22HB, the @p TSensor base selects the transport,
+//! see @ref StaticSensor for alternatives to the runtime-selected @ref Sensor
+template<class TSensor = Sensor> class LPS22HBT : public LPS22HBBase, TSensor
+{
+    using TSensor::ReadRegister;
+    using TSensor::WriteRegister;
+    using TSensor::MYDBG;
+    using TSensor::RegisterFrameSize;
+#if SENSOR_STATS
+    using TSensor::Stats;
+#endif
+
+public:
+    LPS22HBT(bus::I2C i2c, Address address)
+        : TSensor(i2c, (uint8_t)address)
+    {
+    }
+
+    LPS22HBT(bus::SPI spi, GPIOPin cs)
+        : TSensor(spi, cs, 0x80, 0x00)
+    {
+    }
+
+    //! Initializes the sensor
+    async(Init, Rate rate = RateOneShot, Filter filter = FilterOff) { return async_forward(InitImpl, InitConfig(rate | filter, Control2::FifoEnable | Control2::AutoAddrIncrement, FifoControl::ModeDynamicStream)); }
+    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
+    //! If current rate is @ref Control2::RateOneShot, a measurement is triggered and result is retrieved
+    async(Measure);
+    //! Retrieves fifo contents
+    template<size_t n> async(ReadFifo, Sample (&buffer)[n]) { return async_forward(ReadFifo, buffer, n); }
+    //! Retrieves fifo contents
+    async(ReadFifo, Sample* buffer, size_t count);
+
+    //! Checks if the sensor is initialized
+    bool Initialized() const { return init; }
+    //! Gets the last measured pressure in hPa; NaN if not available
+    float GetPressure() const { return pressure; }
+    //! Gets the last measured temperature in degrees celsius; NaN if not available
+    float GetTemperature() const { return temperature; }
+
+#if SENSOR_STATS
+    //! Gets the bus transfer and measurement statistics
+    using TSensor::Statistics;
+#endif
+
+protected:
+    const char* DebugComponent() const { return "LPS22HB"; }
+
+private:
+    Control1 CurrentRate() const { return cfg.ctl1 & Control1::RateMask; }
 
     async(InitImpl, InitConfig cfg);
     async(Trigger);
@@ -192,10 +225,25 @@ private:
     bool init = false;
     InitConfig cfg;
     float pressure = NAN, temperature = NAN;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry InitImpl = { FrameSize<uint8_t>, RegisterFrameSize };
+        static constexpr FrameEntry Trigger = { FrameSize<Control2>, RegisterFrameSize };
+        static constexpr FrameEntry DataReady = { FrameSize<FifoStatus>, RegisterFrameSize };
+        static constexpr FrameEntry WaitForData = { FrameSize<Timeout>, DataReady };
+        static constexpr FrameEntry Measure = { FrameSize<uint8_t[sizeof(Status) + sizeof(Sample)], FrameStatsStart>, FrameMax(InitImpl, Trigger, WaitForData, RegisterFrameSize) };
+        static constexpr FrameEntry ReadFifo = { FrameSize<FifoStatus, size_t>, RegisterFrameSize };
+    };
 };
 
-DEFINE_FLAG_ENUM(LPS22HB::Control1);
-DEFINE_FLAG_ENUM(LPS22HB::Control2);
-DEFINE_FLAG_ENUM(LPS22HB::Status);
+//! LPS22HB driver with the transport selected at runtime
+class LPS22HB : public LPS22HBT<>
+{
+public:
+    using LPS22HBT::LPS22HBT;
+};
 
 }
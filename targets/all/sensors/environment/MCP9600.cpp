@@ -26,6 +26,7 @@ async_def(
     } config;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     if (!init)
     {
 #if DEBUG
@@ -52,10 +53,35 @@ async_def(
         MYDBG("Init complete, ID: %02X rev %d.%d", f.info.id, f.info.maj, f.info.min);
     }
 
-    if (!init ||
-        config.sensor != sensorConfig ||
-        config.device != deviceConfig ||
-        (deviceConfig & DeviceConfig::_ModeMask) == DeviceConfig::ModeBurst)
+    if (init &&
+        config.sensor == sensorConfig &&
+        !((config.device ^ deviceConfig) & ~DeviceConfig::_ModeMask))
+    {
+        // only the mode is changing (typically a burst trigger), the sensor configuration
+        // is still valid, so just clear status and write the new mode
+        if (config.device != deviceConfig ||
+            (deviceConfig & DeviceConfig::_ModeMask) == DeviceConfig::ModeBurst)
+        {
+            f.config.status = 0;
+            if (!await(WriteRegister, Register::Status, f.config.status))
+            {
+                init = false;
+                async_return(false);
+            }
+
+            f.config.device = deviceConfig;
+            if (!await(WriteRegister, Register::DeviceConfig, f.config.device))
+            {
+                init = false;
+                async_return(false);
+            }
+
+            config.device = (deviceConfig & DeviceConfig::_ModeMask) == DeviceConfig::ModeBurst ?
+                deviceConfig ^ (DeviceConfig::ModeBurst ^ DeviceConfig::ModeShutdown) : // replace ModeBurst with ModeShutdown for stored configuration
+                deviceConfig;
+        }
+    }
+    else
     {
         // always fully reinitialize the sensor on change
         init = false;
@@ -104,6 +130,7 @@ async_end
 async(MCP9600::Trigger)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Trigger);
     // force init to burst mode
     if (!await(Init, config.sensor, (config.device & ~DeviceConfig::_ModeMask) | DeviceConfig::ModeBurst))
     {
@@ -146,6 +173,7 @@ async_def(
 #endif
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
     f.timeout = timeout.MakeAbsolute();
 
     if (!init && !await(Init, config.sensor, config.device))
@@ -156,13 +184,22 @@ again:
     // check if data available and if sensor hasn't been reset
     if (!await(ReadRegister, Register::Status, f.status))
     {
-        init = false;
-        async_return(false);
+        // a single glitch on the bus, repeat the transaction
+        if (!await(ReadRegister, Register::Status, f.status))
+        {
+            SENSOR_STATS_COUNT(resets);
+            init = false;
+            async_return(false);
+        }
+        SENSOR_STATS_COUNT(retries);
     }
 
+    // the status block includes the configuration, so the device is verified with every read,
+    // a lost configuration is rewritten by Init, the MCP9600 has no reset to go through
     if (f.status.scfg != config.sensor)
     {
         MYDBG("Sensor config reset, expected %02X, found %02X", config.sensor, f.status.scfg);
+        SENSOR_STATS_COUNT(restored);
         init = false;
         async_return(false);
     }
@@ -172,6 +209,7 @@ again:
         if (!!((f.status.dcfg ^ config.device) & ~DeviceConfig::_ModeMask))
         {
             MYDBG("Device config reset, expected %02X, found %02X", config.device, f.status.dcfg);
+            SENSOR_STATS_COUNT(restored);
             init = false;
             async_return(false);
         }
@@ -199,8 +237,13 @@ again:
     // read current values
     if (!await(ReadRegister, Register::HotJunction, f.data))
     {
-        init = false;
-        async_return(false);
+        if (!await(ReadRegister, Register::HotJunction, f.data))
+        {
+            SENSOR_STATS_COUNT(resets);
+            init = false;
+            async_return(false);
+        }
+        SENSOR_STATS_COUNT(retries);
     }
 
     tempHot = int16_t(FROM_BE16(f.data.tHot)) * TEMP_MUL;
@@ -223,4 +266,12 @@ retry:
 }
 async_end
 
+#ifndef SENSOR_FRAME_BUDGET_MCP9600
+#define SENSOR_FRAME_BUDGET_MCP9600    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(MCP9600, Init, MCP9600::FrameSizes::Init);
+SENSOR_FRAME_CHECK(MCP9600, Trigger, MCP9600::FrameSizes::Trigger);
+SENSOR_FRAME_CHECK(MCP9600, Measure, MCP9600::FrameSizes::Measure);
+
 }
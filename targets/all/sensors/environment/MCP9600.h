@@ -119,6 +119,19 @@ private:
     } config;
     float tempCold, tempHot;
     int32_t raw;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Init = { FrameSize<uint8_t[2], uint8_t>, RegisterFrameSize };
+        static constexpr FrameEntry Trigger = { FrameSize<>, Init };
+#if TRACE && SENSOR_TRACE
+        static constexpr FrameEntry Measure = { FrameSize<uint8_t[9], uint8_t[3], Timeout, int>, FrameMax(Init, RegisterFrameSize) };
+#else
+        static constexpr FrameEntry Measure = { FrameSize<uint8_t[9], uint8_t[3], Timeout>, FrameMax(Init, RegisterFrameSize) };
+#endif
+    };
 };
 
 DEFINE_FLAG_ENUM(MCP9600::SensorConfig);
@@ -19,6 +19,7 @@ namespace sensors::environment
 async(MS5611::InitImpl, InitConfig config)
 async_def(uint8_t u; uint16_t reg;)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::InitImpl);
     init = false;
     cfg = config;
 
@@ -51,6 +52,7 @@ async_def(
     Timeout t;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
     if (!init && !await(InitImpl, cfg))
     {
         async_return(false);
@@ -123,6 +125,13 @@ async_def(
 }
 async_end
 
+#ifndef SENSOR_FRAME_BUDGET_MS5611
+#define SENSOR_FRAME_BUDGET_MS5611    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(MS5611, InitImpl, MS5611::FrameSizes::InitImpl);
+SENSOR_FRAME_CHECK(MS5611, Measure, MS5611::FrameSizes::Measure);
+
 }
 
 
@@ -95,6 +95,14 @@ private:
         struct { uint16_t c1, c2, c3, c4, c5, c6; };
     };
     float pressure = NAN, temperature = NAN;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry InitImpl = { FrameSize<uint8_t, uint16_t>, RegisterFrameSize };
+        static constexpr FrameEntry Measure = { FrameSize<unsigned, uint32_t[2], Timeout>, FrameMax(InitImpl, RegisterFrameSize) };
+    };
 };
 
 }
@@ -14,6 +14,7 @@ namespace sensors::environment
 async(SHTC3::Init)
 async_def(uint8_t id[3])
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     MYDBG("Initializing...");
 
     // it's likely that the SHTC3 is sleeping
@@ -49,6 +50,7 @@ async_end
 async(SHTC3::WriteCommand, Command cmd, Next next)
 async_def(uint8_t cmd[2])
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::WriteCommand);
     f.cmd[0] = (unsigned)cmd >> 8;
     f.cmd[1] = (uint8_t)cmd;
 
@@ -67,6 +69,7 @@ async_end
 async(SHTC3::Measure)
 async_def(uint8_t data[6]; bool success;)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
     if (!init)
     {
         await(Init);
@@ -101,4 +104,11 @@ async_def(uint8_t data[6]; bool success;)
 }
 async_end
 
+#ifndef SENSOR_FRAME_BUDGET_SHTC3
+#define SENSOR_FRAME_BUDGET_SHTC3    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(SHTC3, Init, SHTC3::FrameSizes::Init);
+SENSOR_FRAME_CHECK(SHTC3, Measure, SHTC3::FrameSizes::Measure);
+
 }
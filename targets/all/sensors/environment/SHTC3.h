@@ -62,6 +62,15 @@ private:
     };
 
 	async(WriteCommand, Command cmd, Next next = Next::Stop);
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry WriteCommand = { FrameSize<uint8_t[2]>, BusFrameSize };
+        static constexpr FrameEntry Init = { FrameSize<uint8_t[3]>, FrameMax(WriteCommand, BusFrameSize) };
+        static constexpr FrameEntry Measure = { FrameSize<uint8_t[6], bool>, FrameMax(Init, WriteCommand, BusFrameSize) };
+    };
 };
 
 }
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/Ahrs.cpp
+ */
+
+#include "Ahrs.h"
+
+#include <math.h>
+
+namespace sensors::fusion
+{
+
+using position::LSM6DSOBase;
+
+static constexpr float DegToRad = float(M_PI / 180);
+
+//! Normalizes a measured direction, returns false if it is zero (or invalid)
+static inline bool Normalize(float& x, float& y, float& z)
+{
+    float n = x * x + y * y + z * z;
+    if (!(n > 0))
+    {
+        return false;
+    }
+    n = 1 / sqrtf(n);
+    x *= n;
+    y *= n;
+    z *= n;
+    return true;
+}
+
+//! Calculates the reference magnetic field in the earth frame, i.e. the measured field
+//! rotated to the earth frame with its horizontal component moved to the x axis,
+//! which makes the magnetometer affect only the heading
+static inline void FieldReference(const Quaternion& q, float mx, float my, float mz, float& bx, float& bz)
+{
+    float q0 = q.w, q1 = q.x, q2 = q.y, q3 = q.z;
+    float hx = mx * (1 - 2 * (q2 * q2 + q3 * q3)) + 2 * my * (q1 * q2 - q0 * q3) + 2 * mz * (q1 * q3 + q0 * q2);
+    float hy = 2 * mx * (q1 * q2 + q0 * q3) + my * (1 - 2 * (q1 * q1 + q3 * q3)) + 2 * mz * (q2 * q3 - q0 * q1);
+    bz = 2 * mx * (q1 * q3 - q0 * q2) + 2 * my * (q2 * q3 + q0 * q1) + mz * (1 - 2 * (q1 * q1 + q2 * q2));
+    bx = sqrtf(hx * hx + hy * hy);
+}
+
+void Ahrs::Update(const XYZ& gyro, const XYZ& accel, float dt)
+{
+    Step(gyro, accel, NULL, dt);
+}
+
+void Ahrs::Update(const XYZ& gyro, const XYZ& accel, const XYZ& mag, float dt)
+{
+    Step(gyro, accel, &mag, dt);
+}
+
+size_t Ahrs::Update(const LSM6DSOBase& imu, const LSM6DSOBase::FifoSample* samples, size_t count, float dt, int magSlot, float magMul)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& smp = samples[i];
+        switch (smp.Tag())
+        {
+            case LSM6DSOBase::FifoTag::AccelNc: case LSM6DSOBase::FifoTag::AccelNcT1: case LSM6DSOBase::FifoTag::AccelNcT2:
+            {
+                auto v = imu.FifoSampleValue(smp);
+                accel = { v.x, v.y, v.z };
+                break;
+            }
+
+            case LSM6DSOBase::FifoTag::GyroNc: case LSM6DSOBase::FifoTag::GyroNcT1: case LSM6DSOBase::FifoTag::GyroNcT2:
+            {
+                auto v = imu.FifoSampleValue(smp);
+                Step({ v.x, v.y, v.z }, accel, magSlot >= 0 ? &mag : NULL, dt);
+                n++;
+                break;
+            }
+
+            default:
+                if (magSlot >= 0 && smp.HubSlot() == magSlot)
+                {
+                    auto v = LSM6DSOBase::HubSampleValue(smp, magMul);
+                    mag = { v.x, v.y, v.z };
+                }
+                break;
+        }
+    }
+    return n;
+}
+
+XYZ Ahrs::GyroBias() const
+{
+    return { bias.x / DegToRad, bias.y / DegToRad, bias.z / DegToRad };
+}
+
+void Ahrs::Step(const XYZ& gyro, const XYZ& accel, const XYZ* mag, float dt)
+{
+    float gx = gyro.x * DegToRad, gy = gyro.y * DegToRad, gz = gyro.z * DegToRad;
+    if (settings.algorithm == Algorithm::Mahony)
+    {
+        UpdateMahony(gx, gy, gz, accel.x, accel.y, accel.z, mag, dt);
+    }
+    else
+    {
+        UpdateMadgwick(gx, gy, gz, accel.x, accel.y, accel.z, mag, dt);
+    }
+    updates++;
+}
+
+void Ahrs::UpdateMadgwick(float gx, float gy, float gz, float ax, float ay, float az, const XYZ* mag, float dt)
+{
+    float q0 = q.w, q1 = q.x, q2 = q.y, q3 = q.z;
+    float s[4] = {};
+
+    if (Normalize(ax, ay, az))
+    {
+        // gradient of the gravity objective function, J_g' * f_g
+        float f1 = 2 * (q1 * q3 - q0 * q2) - ax;
+        float f2 = 2 * (q0 * q1 + q2 * q3) - ay;
+        float f3 = 1 - 2 * (q1 * q1 + q2 * q2) - az;
+        s[0] = -2 * q2 * f1 + 2 * q1 * f2;
+        s[1] = 2 * q3 * f1 + 2 * q0 * f2 - 4 * q1 * f3;
+        s[2] = -2 * q0 * f1 + 2 * q3 * f2 - 4 * q2 * f3;
+        s[3] = 2 * q1 * f1 + 2 * q2 * f2;
+
+        float mx = mag ? mag->x : 0, my = mag ? mag->y : 0, mz = mag ? mag->z : 0;
+        if (Normalize(mx, my, mz))
+        {
+            // gradient of the magnetic field objective function, J_b' * f_b
+            float bx, bz;
+            FieldReference(q, mx, my, mz, bx, bz);
+            f1 = bx * (1 - 2 * (q2 * q2 + q3 * q3)) + 2 * bz * (q1 * q3 - q0 * q2) - mx;
+            f2 = 2 * bx * (q1 * q2 - q0 * q3) + 2 * bz * (q0 * q1 + q2 * q3) - my;
+            f3 = 2 * bx * (q0 * q2 + q1 * q3) + bz * (1 - 2 * (q1 * q1 + q2 * q2)) - mz;
+            s[0] += -2 * bz * q2 * f1 + (-2 * bx * q3 + 2 * bz * q1) * f2 + 2 * bx * q2 * f3;
+            s[1] += 2 * bz * q3 * f1 + (2 * bx * q2 + 2 * bz * q0) * f2 + (2 * bx * q3 - 4 * bz * q1) * f3;
+            s[2] += (-4 * bx * q2 - 2 * bz * q0) * f1 + (2 * bx * q1 + 2 * bz * q3) * f2 + (2 * bx * q0 - 4 * bz * q2) * f3;
+            s[3] += (-4 * bx * q3 + 2 * bz * q1) * f1 + (-2 * bx * q0 + 2 * bz * q2) * f2 + 2 * bx * q1 * f3;
+        }
+
+        float n = s[0] * s[0] + s[1] * s[1] + s[2] * s[2] + s[3] * s[3];
+        if (n > 0)
+        {
+            n = 1 / sqrtf(n);
+            for (auto& v : s)
+            {
+                v *= n;
+            }
+
+            if (settings.biasGain)
+            {
+                // the step expressed as angular rate in the sensor frame (2 * q^-1 * s) is the gyroscope error
+                float k = 2 * settings.biasGain * dt;
+                bias.x += k * (q0 * s[1] - q1 * s[0] - q2 * s[3] + q3 * s[2]);
+                bias.y += k * (q0 * s[2] + q1 * s[3] - q2 * s[0] - q3 * s[1]);
+                bias.z += k * (q0 * s[3] - q1 * s[2] + q2 * s[1] - q3 * s[0]);
+            }
+
+            for (auto& v : s)
+            {
+                v *= settings.gain;
+            }
+        }
+    }
+
+    Integrate(gx - bias.x, gy - bias.y, gz - bias.z, dt, s);
+}
+
+void Ahrs::UpdateMahony(float gx, float gy, float gz, float ax, float ay, float az, const XYZ* mag, float dt)
+{
+    float q0 = q.w, q1 = q.x, q2 = q.y, q3 = q.z;
+
+    if (Normalize(ax, ay, az))
+    {
+        // error between the measured and estimated direction of gravity
+        float vx = 2 * (q1 * q3 - q0 * q2);
+        float vy = 2 * (q0 * q1 + q2 * q3);
+        float vz = 1 - 2 * (q1 * q1 + q2 * q2);
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        float mx = mag ? mag->x : 0, my = mag ? mag->y : 0, mz = mag ? mag->z : 0;
+        if (Normalize(mx, my, mz))
+        {
+            // error between the measured and estimated direction of the magnetic field
+            float bx, bz;
+            FieldReference(q, mx, my, mz, bx, bz);
+            float wx = bx * (1 - 2 * (q2 * q2 + q3 * q3)) + 2 * bz * (q1 * q3 - q0 * q2);
+            float wy = 2 * bx * (q1 * q2 - q0 * q3) + 2 * bz * (q0 * q1 + q2 * q3);
+            float wz = 2 * bx * (q0 * q2 + q1 * q3) + bz * (1 - 2 * (q1 * q1 + q2 * q2));
+            ex += my * wz - mz * wy;
+            ey += mz * wx - mx * wz;
+            ez += mx * wy - my * wx;
+        }
+
+        if (settings.biasGain)
+        {
+            // the integral term converges to the negated gyroscope bias
+            bias.x -= settings.biasGain * ex * dt;
+            bias.y -= settings.biasGain * ey * dt;
+            bias.z -= settings.biasGain * ez * dt;
+        }
+
+        gx += settings.gain * ex;
+        gy += settings.gain * ey;
+        gz += settings.gain * ez;
+    }
+
+    Integrate(gx - bias.x, gy - bias.y, gz - bias.z, dt);
+}
+
+void Ahrs::Integrate(float gx, float gy, float gz, float dt, const float* step)
+{
+    float q0 = q.w, q1 = q.x, q2 = q.y, q3 = q.z;
+
+    // rate of change of the quaternion, 0.5 * q * (0, g)
+    float d0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float d1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float d2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float d3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    if (step)
+    {
+        d0 -= step[0];
+        d1 -= step[1];
+        d2 -= step[2];
+        d3 -= step[3];
+    }
+
+    q0 += d0 * dt;
+    q1 += d1 * dt;
+    q2 += d2 * dt;
+    q3 += d3 * dt;
+
+    float n = 1 / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q = { q0 * n, q1 * n, q2 * n, q3 * n };
+}
+
+}
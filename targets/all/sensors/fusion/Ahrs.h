@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/Ahrs.h
+ *
+ * Attitude and heading estimation from gyroscope, accelerometer and optional
+ * magnetometer samples, using either the Madgwick (gradient descent) or the
+ * Mahony (complementary PI) filter, both with gyroscope bias estimation
+ *
+ * The filter runs one update per gyroscope sample directly on the blocks drained
+ * from the LSM6DSO FIFO, see @ref Ahrs::Update(const position::LSM6DSOBase&, ...)
+ *
+ * The library does not benchmark the update, whether it keeps up with the selected
+ * gyroscope rate has to be measured on the target, e.g. by comparing @ref Ahrs::Updates
+ * against the time spent in the updates
+ */
+
+#pragma once
+
+#include <sensors/types.h>
+#include <sensors/position/LSM6DSO.h>
+
+namespace sensors::fusion
+{
+
+//! Unit quaternion rotating vectors from the sensor frame to the earth frame
+struct Quaternion
+{
+    float w, x, y, z;
+};
+
+class Ahrs
+{
+public:
+    enum struct Algorithm : uint8_t
+    {
+        Madgwick,
+        Mahony,
+    };
+
+    struct Settings
+    {
+        Algorithm algorithm;
+        //! Madgwick: gradient descent step (beta), Mahony: proportional gain (Kp)
+        float gain;
+        //! Madgwick: gyroscope drift gain (zeta), Mahony: integral gain (Ki),
+        //! zero disables the estimation of the gyroscope bias
+        float biasGain;
+    };
+
+    Ahrs(const Settings& settings)
+        : settings(settings) {}
+
+    //! Integrates a gyroscope sample in dps over @p dt seconds, corrected by the direction of
+    //! gravity (in any unit, zero skips the correction)
+    void Update(const XYZ& gyro, const XYZ& accel, float dt);
+    //! Integrates a gyroscope sample in dps over @p dt seconds, corrected by the direction of
+    //! gravity and the magnetic field (in any units, zero skips the respective correction)
+    void Update(const XYZ& gyro, const XYZ& accel, const XYZ& mag, float dt);
+    //! Processes a block of entries read by @ref position::LSM6DSO::ReadFifo, running one update
+    //! per gyroscope entry with the latest accelerometer (and magnetometer) data
+    //! @param dt gyroscope sampling period in seconds
+    //! @param magSlot sensor hub slot of the magnetometer (see @ref position::LSM6DSO::HubSampleValue),
+    //! -1 if there is none
+    //! @param magMul multiplier converting the raw magnetometer values
+    //! @return the number of updates performed
+    size_t Update(const position::LSM6DSOBase& imu, const position::LSM6DSOBase::FifoSample* samples, size_t count,
+        float dt, int magSlot = -1, float magMul = 1);
+
+    //! Gets the estimated orientation
+    const Quaternion& Orientation() const { return q; }
+    //! Gets the estimated gyroscope bias in dps, already subtracted from the samples
+    XYZ GyroBias() const;
+    //! Gets the total number of updates performed since construction
+    uint32_t Updates() const { return updates; }
+
+    //! Sets the orientation, e.g. from an initial accelerometer/magnetometer measurement
+    void SetOrientation(const Quaternion& orientation) { q = orientation; }
+    //! Resets the orientation and the bias estimate
+    void Reset() { q = { 1, 0, 0, 0 }; bias = { 0, 0, 0 }; accel = mag = { 0, 0, 0 }; }
+
+private:
+    Settings settings;
+    Quaternion q = { 1, 0, 0, 0 };
+    //! Bias estimate in rad/s
+    XYZ bias = { 0, 0, 0 };
+    //! Latest accelerometer and magnetometer data for batch updates
+    XYZ accel = { 0, 0, 0 }, mag = { 0, 0, 0 };
+    uint32_t updates = 0;
+
+    void Step(const XYZ& gyro, const XYZ& accel, const XYZ* mag, float dt);
+    void UpdateMadgwick(float gx, float gy, float gz, float ax, float ay, float az, const XYZ* mag, float dt);
+    void UpdateMahony(float gx, float gy, float gz, float ax, float ay, float az, const XYZ* mag, float dt);
+    //! Integrates the rate of rotation (in rad/s), optionally descending along the normalized gradient @p step
+    void Integrate(float gx, float gy, float gz, float dt, const float* step = NULL);
+};
+
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/ImuBias.cpp
+ */
+
+#include "ImuBias.h"
+
+#include <math.h>
+
+namespace sensors::fusion
+{
+
+void ImuBias::Reset()
+{
+    win = {};
+    weight = tWeight = st = stt = 0;
+    for (unsigned i = 0; i < 3; i++)
+    {
+        sb[i] = tsb[i] = stb[i] = 0;
+    }
+    sdd = {};
+    sdy = {};
+    stationary = false;
+}
+
+bool ImuBias::Add(const XYZ& gyro, const XYZ& accel, float temp)
+{
+    const float g[3] = { gyro.x, gyro.y, gyro.z };
+    const float a[3] = { accel.x, accel.y, accel.z };
+    for (unsigned i = 0; i < 3; i++)
+    {
+        win.g[i] += g[i];
+        win.gg[i] += g[i] * g[i];
+        win.a[i] += a[i];
+        win.aa[i] += a[i] * a[i];
+    }
+    if (!isnan(temp))
+    {
+        win.t += temp - TempReference;
+        win.tCount++;
+    }
+
+    if (++win.count < settings.window)
+    {
+        return false;
+    }
+
+    float n = win.count;
+    float gm[3], am[3];
+    float gVar = 0, aVar = 0;
+    for (unsigned i = 0; i < 3; i++)
+    {
+        gm[i] = win.g[i] / n;
+        am[i] = win.a[i] / n;
+        gVar = fmaxf(gVar, win.gg[i] / n - gm[i] * gm[i]);
+        aVar = fmaxf(aVar, win.aa[i] / n - am[i] * am[i]);
+    }
+    float t = win.tCount ? win.t / win.tCount : NAN;
+    win = {};
+
+    stationary = gVar < settings.gyroStill * settings.gyroStill && aVar < settings.accelStill * settings.accelStill;
+    if (!stationary)
+    {
+        return false;
+    }
+
+    // weighted least squares of bias = b0 + k * t with exponential forgetting,
+    // windows without temperature contribute only to the mean bias
+    float l = settings.forgetting;
+    bool hasTemp = !isnan(t);
+    weight = weight * l + 1;
+    tWeight = tWeight * l + hasTemp;
+    st = st * l + (hasTemp ? t : 0);
+    stt = stt * l + (hasTemp ? t * t : 0);
+    for (unsigned i = 0; i < 3; i++)
+    {
+        sb[i] = sb[i] * l + gm[i];
+        tsb[i] = tsb[i] * l + (hasTemp ? gm[i] : 0);
+        stb[i] = stb[i] * l + (hasTemp ? t * gm[i] : 0);
+    }
+
+    // only the projection of the offset to the direction of gravity is observable
+    float norm = sqrtf(am[0] * am[0] + am[1] * am[1] + am[2] * am[2]);
+    if (norm > 0)
+    {
+        Matrix<3, 1> d = {{ { am[0] / norm }, { am[1] / norm }, { am[2] / norm } }};
+        sdd = sdd * l + d * d.Transpose();
+        sdy = sdy * l + d * (norm - 1);
+    }
+    return true;
+}
+
+XYZ ImuBias::GyroBias(float temp) const
+{
+    if (!(weight > 0))
+    {
+        return { 0, 0, 0 };
+    }
+
+    float b[3];
+    if (!isnan(temp) && tWeight > 0)
+    {
+        float tm = st / tWeight;
+        float tVar = stt / tWeight - tm * tm;
+        if (tVar > settings.minTempSpread * settings.minTempSpread)
+        {
+            // the regression line runs through the means over the windows with temperature
+            float dt = temp - TempReference - tm;
+            for (unsigned i = 0; i < 3; i++)
+            {
+                float bm = tsb[i] / tWeight;
+                float k = (stb[i] / tWeight - tm * bm) / tVar;
+                b[i] = bm + k * dt;
+            }
+            return { b[0], b[1], b[2] };
+        }
+    }
+
+    for (unsigned i = 0; i < 3; i++)
+    {
+        b[i] = sb[i] / weight;
+    }
+    return { b[0], b[1], b[2] };
+}
+
+XYZ ImuBias::AccelOffset() const
+{
+    // solve the regularized normal equations by the adjugate, the matrix is symmetric positive definite
+    auto m = sdd + Matrix<3, 3>::Identity() * OffsetPrior;
+    float c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(1, 2);
+    float c01 = m(0, 2) * m(1, 2) - m(0, 1) * m(2, 2);
+    float c02 = m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1);
+    float c11 = m(0, 0) * m(2, 2) - m(0, 2) * m(0, 2);
+    float c12 = m(0, 2) * m(0, 1) - m(0, 0) * m(1, 2);
+    float c22 = m(0, 0) * m(1, 1) - m(0, 1) * m(0, 1);
+    float det = m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+    auto& y = sdy;
+    return {
+        (c00 * y[0] + c01 * y[1] + c02 * y[2]) / det,
+        (c01 * y[0] + c11 * y[1] + c12 * y[2]) / det,
+        (c02 * y[0] + c12 * y[1] + c22 * y[2]) / det,
+    };
+}
+
+}
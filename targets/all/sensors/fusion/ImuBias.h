@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/ImuBias.h
+ *
+ * Estimation of the gyroscope bias and accelerometer offset from the periods
+ * when the sensor is stationary
+ *
+ * Samples are evaluated in windows, a window with low variance of both
+ * the angular rate and the acceleration is stationary. Its mean angular rate
+ * is a measurement of the gyroscope bias, the difference between the magnitude
+ * of its mean acceleration and 1 g is a measurement of the accelerometer offset
+ * projected to the direction of gravity, so the offset of all axes converges
+ * as the sensor is left resting in different orientations. The gyroscope
+ * bias is optionally modelled as a linear function of the temperature.
+ *
+ * The accelerometer offset can be pushed into the sensor, e.g.
+ * @ref position::LSM6DSO::ConfigureAccelOffset, so that its consumers get
+ * corrected data without any processing.
+ */
+
+#pragma once
+
+#include <sensors/types.h>
+
+#include "Matrix.h"
+
+namespace sensors::fusion
+{
+
+class ImuBias
+{
+public:
+    struct Settings
+    {
+        //! Number of samples evaluated together
+        uint16_t window;
+        //! Maximum standard deviation of the angular rate (dps) in a stationary window
+        float gyroStill;
+        //! Maximum standard deviation of the acceleration (g) in a stationary window
+        float accelStill;
+        //! Weight of the previous stationary windows when a new one is added (e.g. 0.95)
+        float forgetting;
+        //! Minimum standard deviation of the temperature (degC) over the stationary windows
+        //! before the temperature coefficient of the gyroscope bias is used
+        float minTempSpread;
+    };
+
+    ImuBias(const Settings& settings)
+        : settings(settings) { Reset(); }
+
+    //! Adds a sample of angular rate in dps and uncorrected acceleration in g,
+    //! @p temp (degC) is NAN if not available
+    //! @return true if a stationary window has been completed and the estimates updated
+    bool Add(const XYZ& gyro, const XYZ& accel, float temp = NAN);
+    //! Adds a sample measured by a sensor that already subtracts the accelerometer offset @p hwOffset
+    bool Add(const XYZ& gyro, const XYZ& accel, const XYZ& hwOffset, float temp)
+    {
+        return Add(gyro, { accel.x + hwOffset.x, accel.y + hwOffset.y, accel.z + hwOffset.z }, temp);
+    }
+
+    //! Checks if at least one stationary window has been seen
+    bool IsValid() const { return weight > 0; }
+    //! Checks if the last completed window was stationary
+    bool IsStationary() const { return stationary; }
+    //! Gets the gyroscope bias in dps at temperature @p temp (degC), NAN gives the mean bias
+    //! over all stationary windows
+    XYZ GyroBias(float temp = NAN) const;
+    //! Gets the accelerometer offset in g
+    XYZ AccelOffset() const;
+
+    //! Discards all estimates
+    void Reset();
+
+private:
+    //! Temperatures are relative to this value to keep the sums well conditioned
+    static constexpr float TempReference = 25;
+    //! Regularization of the accelerometer offset, keeps the offset of axes that have not been observed at zero
+    static constexpr float OffsetPrior = 1e-3f;
+
+    Settings settings;
+
+    //! Sums over the current window
+    struct
+    {
+        float g[3], gg[3];
+        float a[3], aa[3];
+        float t;
+        uint16_t count, tCount;
+    } win;
+
+    //! Exponentially weighted sums over the stationary windows
+    float weight;
+    float sb[3];
+    //! Exponentially weighted sums of the temperature regression, over the stationary windows with a temperature reading
+    float tWeight, st, stt;
+    float tsb[3], stb[3];
+    //! Normal equations of the accelerometer offset, sum of d * d' and d * (|a| - 1) over gravity directions d
+    Matrix<3, 3> sdd;
+    Matrix<3, 1> sdy;
+    bool stationary;
+};
+
+}
@@ -0,0 +1,9 @@
+#
+# Copyright (c) 2024 triaxis s.r.o.
+# Licensed under the MIT license. See LICENSE.txt file in the repository root
+# for full license information.
+#
+# sensors/fusion/Include.mk
+#
+
+COMPONENTS += sensors
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/Kalman.h
+ *
+ * Kalman filter with a compile-time sized state, measurements are processed
+ * one scalar at a time, which replaces the inversion of the innovation
+ * covariance with a division
+ */
+
+#pragma once
+
+#include "Matrix.h"
+
+namespace sensors::fusion
+{
+
+template<size_t N> class KalmanFilter
+{
+public:
+    using Vector = Matrix<N, 1>;
+    using Square = Matrix<N, N>;
+    using Row = Matrix<1, N>;
+
+    //! Gets the state estimate
+    const Vector& State() const { return x; }
+    //! Gets the covariance of the state estimate
+    const Square& Covariance() const { return p; }
+    //! Gets an element of the state estimate
+    float operator[](size_t i) const { return x[i]; }
+    //! Gets the variance of an element of the state estimate
+    float Variance(size_t i) const { return p(i, i); }
+
+    //! Sets the state estimate and its covariance
+    void Reset(const Vector& state, const Square& covariance) { x = state; p = covariance; }
+    //! Sets a single element of the state, e.g. once it becomes observable, without correlation to the other elements
+    void Reset(size_t i, float value, float variance)
+    {
+        x[i] = value;
+        for (size_t j = 0; j < N; j++)
+        {
+            p(i, j) = p(j, i) = 0;
+        }
+        p(i, i) = variance;
+    }
+
+    //! Propagates the state, x = F * x + u, P = F * P * F' + Q
+    void Predict(const Square& f, const Vector& u, const Square& q)
+    {
+        x = f * x + u;
+        p = f * p * f.Transpose() + q;
+    }
+
+    //! Applies a scalar measurement z = h * x with variance @p r
+    //! @param gate rejects measurements with innovation larger than this many standard deviations, zero disables the check
+    //! @return false if the measurement has been rejected
+    bool Update(const Row& h, float z, float r, float gate = 0)
+    {
+        float y = z - (h * x)(0, 0);
+        Vector ph = p * h.Transpose();
+        float s = (h * ph)(0, 0) + r;
+        if (!(s > 0) || (gate > 0 && y * y > gate * gate * s))
+        {
+            return false;
+        }
+
+        Vector k = ph * (1 / s);
+        x = x + k * y;
+        // K * H * P == K * (P * H')' as P is symmetric
+        p = p - k * ph.Transpose();
+        return true;
+    }
+
+    //! Applies a direct measurement of state element @p i, see @ref Update(const Row&, float, float, float)
+    bool Update(size_t i, float z, float r, float gate = 0)
+    {
+        Row h = {};
+        h(0, i) = 1;
+        return Update(h, z, r, gate);
+    }
+
+private:
+    Vector x = {};
+    Square p = {};
+};
+
+}
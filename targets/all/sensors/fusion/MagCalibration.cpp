@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/MagCalibration.cpp
+ */
+
+#include "MagCalibration.h"
+
+#include <math.h>
+
+namespace sensors::fusion
+{
+
+//! Diagonalizes a symmetric matrix using Jacobi rotations, the eigenvalues are left
+//! on the diagonal of @p a, the eigenvectors are the columns of @p v
+static void Eigen(Matrix<3, 3>& a, Matrix<3, 3>& v)
+{
+    v = Matrix<3, 3>::Identity();
+    for (int sweep = 0; sweep < 16; sweep++)
+    {
+        float off = a(0, 1) * a(0, 1) + a(0, 2) * a(0, 2) + a(1, 2) * a(1, 2);
+        float diag = a(0, 0) * a(0, 0) + a(1, 1) * a(1, 1) + a(2, 2) * a(2, 2);
+        if (off <= 1e-12f * diag)
+        {
+            break;
+        }
+
+        for (size_t p = 0; p < 2; p++)
+        {
+            for (size_t q = p + 1; q < 3; q++)
+            {
+                if (a(p, q) == 0)
+                {
+                    continue;
+                }
+
+                float theta = (a(q, q) - a(p, p)) / (2 * a(p, q));
+                float t = (theta >= 0 ? 1 : -1) / (fabsf(theta) + sqrtf(theta * theta + 1));
+                float c = 1 / sqrtf(t * t + 1), s = t * c;
+
+                for (size_t k = 0; k < 3; k++)
+                {
+                    float kp = a(k, p), kq = a(k, q);
+                    a(k, p) = c * kp - s * kq;
+                    a(k, q) = s * kp + c * kq;
+                }
+                for (size_t k = 0; k < 3; k++)
+                {
+                    float pk = a(p, k), qk = a(q, k);
+                    a(p, k) = c * pk - s * qk;
+                    a(q, k) = s * pk + c * qk;
+                }
+                for (size_t k = 0; k < 3; k++)
+                {
+                    float kp = v(k, p), kq = v(k, q);
+                    v(k, p) = c * kp - s * kq;
+                    v(k, q) = s * kp + c * kq;
+                }
+            }
+        }
+    }
+}
+
+void MagCalibration::Reset()
+{
+    norm = 2 / (settings.minField + settings.maxField);
+    theta = {};
+    p = Matrix<9, 9>::Identity() * InitialCovariance;
+    last = { NAN, NAN, NAN };
+    count = 0;
+
+    offset = { 0, 0, 0 };
+    softIron = Matrix<3, 3>::Identity();
+    field = NAN;
+    valid = false;
+}
+
+bool MagCalibration::Add(const XYZ& sample)
+{
+    float dx = sample.x - last.x, dy = sample.y - last.y, dz = sample.z - last.z;
+    if (dx * dx + dy * dy + dz * dz < settings.minSpacing * settings.minSpacing)
+    {
+        return false;
+    }
+    last = sample;
+
+    float x = sample.x * norm, y = sample.y * norm, z = sample.z * norm;
+    Matrix<9, 1> phi = {{ { x * x }, { y * y }, { z * z }, { 2 * x * y }, { 2 * x * z }, { 2 * y * z }, { 2 * x }, { 2 * y }, { 2 * z } }};
+
+    // recursive least squares with exponential forgetting
+    auto pphi = p * phi;
+    float s = settings.forgetting + (phi.Transpose() * pphi)(0, 0);
+    auto k = pphi * (1 / s);
+    theta = theta + k * (1 - (phi.Transpose() * theta)(0, 0));
+    p = (p - k * pphi.Transpose()) * (1 / settings.forgetting);
+    count++;
+    return true;
+}
+
+bool MagCalibration::Solve()
+{
+    if (count < settings.minSamples)
+    {
+        return false;
+    }
+
+    // x' A x + 2 v' x = 1
+    auto& t = theta;
+    Matrix<3, 3> a = {{
+        { t[0], t[3], t[4] },
+        { t[3], t[1], t[5] },
+        { t[4], t[5], t[2] },
+    }};
+
+    // center of the ellipsoid, o = -inv(A) * v
+    float c00 = a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1);
+    float c01 = a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2);
+    float c02 = a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1);
+    float det = a(0, 0) * c00 + a(1, 0) * c01 + a(2, 0) * c02;
+    if (!(fabsf(det) > 0))
+    {
+        return false;
+    }
+    float c11 = a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0);
+    float c12 = a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2);
+    float c22 = a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+    float ox = -(c00 * t[6] + c01 * t[7] + c02 * t[8]) / det;
+    float oy = -(c01 * t[6] + c11 * t[7] + c12 * t[8]) / det;
+    float oz = -(c02 * t[6] + c12 * t[7] + c22 * t[8]) / det;
+
+    // (x - o)' A (x - o) = 1 + o' A o = k, A and k are both negative when the offset
+    // is larger than the radius of the field, so only A / k has to be positive definite
+    float k = 1 - (t[6] * ox + t[7] * oy + t[8] * oz);
+    if (!(fabsf(k) > 0))
+    {
+        return false;
+    }
+
+    Matrix<3, 3> v;
+    a = a * (1 / k);
+    Eigen(a, v);
+    float l0 = a(0, 0), l1 = a(1, 1), l2 = a(2, 2);
+    if (!(l0 > 0 && l1 > 0 && l2 > 0))
+    {
+        return false;
+    }
+
+    // radii are 1 / sqrt(l), the sphere of the same volume has their geometric mean as radius
+    float lmin = fminf(l0, fminf(l1, l2)), lmax = fmaxf(l0, fmaxf(l1, l2));
+    float strength = cbrtf(1 / sqrtf(l0 * l1 * l2)) / norm;
+    if (lmax > lmin * settings.maxDistortion * settings.maxDistortion ||
+        strength < settings.minField || strength > settings.maxField)
+    {
+        return false;
+    }
+
+    // W = V * diag(sqrt(l) * r) * V', symmetric so that the corrected field is not rotated
+    float r = strength * norm;
+    float d[3] = { sqrtf(l0) * r, sqrtf(l1) * r, sqrtf(l2) * r };
+    for (size_t i = 0; i < 3; i++)
+    {
+        for (size_t j = 0; j < 3; j++)
+        {
+            softIron(i, j) = v(i, 0) * d[0] * v(j, 0) + v(i, 1) * d[1] * v(j, 1) + v(i, 2) * d[2] * v(j, 2);
+        }
+    }
+
+    offset = { ox / norm, oy / norm, oz / norm };
+    field = strength;
+    valid = true;
+    return true;
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/MagCalibration.h
+ *
+ * Online hard-iron and soft-iron calibration of a magnetometer
+ *
+ * An ellipsoid is fitted to the measured field by recursive least squares,
+ * so each sample is processed in constant time and memory. The fit is then
+ * converted to an offset and a symmetric correction matrix, which map the
+ * ellipsoid onto a sphere of the same volume. Sensors with offset registers
+ * (e.g. @ref position::LIS3MD::SetOffset) can subtract the offset themselves,
+ * leaving only the matrix to be applied in software.
+ */
+
+#pragma once
+
+#include <sensors/types.h>
+
+#include "Matrix.h"
+
+namespace sensors::fusion
+{
+
+class MagCalibration
+{
+public:
+    struct Settings
+    {
+        //! Forgetting factor of the fit (e.g. 0.999), 1 keeps all samples with the same weight
+        float forgetting;
+        //! Minimum distance from the last used sample, closer samples are ignored so that
+        //! a stationary sensor does not dominate the fit
+        float minSpacing;
+        //! Minimum number of used samples before a solution is accepted
+        uint16_t minSamples;
+        //! Range of the accepted field strength, in the units of the samples
+        float minField, maxField;
+        //! Maximum accepted ratio of the longest and shortest axis of the ellipsoid
+        float maxDistortion;
+    };
+
+    MagCalibration(const Settings& settings)
+        : settings(settings) { Reset(); }
+
+    //! Adds a sample of the uncorrected field, returns false if the sample is too close to the previous one
+    bool Add(const XYZ& field);
+    //! Adds a sample measured by a sensor that already subtracts @p hwOffset (see @ref Add(const XYZ&))
+    bool Add(const XYZ& field, const XYZ& hwOffset) { return Add({ field.x + hwOffset.x, field.y + hwOffset.y, field.z + hwOffset.z }); }
+    //! Converts the current fit to offset and correction matrix, which are kept unchanged
+    //! if the fit is not plausible yet; returns true if a new solution has been accepted
+    bool Solve();
+
+    //! Checks if a solution is available
+    bool IsValid() const { return valid; }
+    //! Gets the hard-iron offset
+    const XYZ& Offset() const { return offset; }
+    //! Gets the soft-iron correction matrix
+    const Matrix<3, 3>& SoftIron() const { return softIron; }
+    //! Gets the strength of the field after correction
+    float FieldStrength() const { return field; }
+    //! Gets the number of samples used in the fit
+    uint32_t Samples() const { return count; }
+
+    //! Corrects an uncorrected sample
+    XYZ Apply(const XYZ& raw) const { return ApplySoftIron({ raw.x - offset.x, raw.y - offset.y, raw.z - offset.z }); }
+    //! Corrects a sample measured by a sensor that already subtracts the offset
+    XYZ ApplySoftIron(const XYZ& v) const
+    {
+        auto& w = softIron;
+        return {
+            w(0, 0) * v.x + w(0, 1) * v.y + w(0, 2) * v.z,
+            w(1, 0) * v.x + w(1, 1) * v.y + w(1, 2) * v.z,
+            w(2, 0) * v.x + w(2, 1) * v.y + w(2, 2) * v.z,
+        };
+    }
+
+    //! Discards the fit and the solution
+    void Reset();
+
+private:
+    static constexpr float InitialCovariance = 100;
+
+    Settings settings;
+    //! Samples are normalized to the middle of the accepted field range to keep the fit well conditioned
+    float norm;
+    //! Coefficients of x^2, y^2, z^2, 2xy, 2xz, 2yz, 2x, 2y, 2z of the normalized ellipsoid equation ... = 1
+    Matrix<9, 1> theta;
+    Matrix<9, 9> p;
+    XYZ last;
+    uint32_t count;
+
+    XYZ offset;
+    Matrix<3, 3> softIron;
+    float field;
+    bool valid;
+};
+
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/Matrix.h
+ *
+ * Minimal fixed-size matrix for small filters, the dimensions are known at
+ * compile time so all operations are unrolled by the compiler and no memory
+ * is allocated
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+namespace sensors::fusion
+{
+
+template<size_t R, size_t C> struct Matrix
+{
+    static constexpr size_t Rows = R, Columns = C;
+
+    float m[R][C];
+
+    constexpr float& operator()(size_t r, size_t c) { return m[r][c]; }
+    constexpr float operator()(size_t r, size_t c) const { return m[r][c]; }
+
+    //! Gets the element of a column vector
+    constexpr float& operator[](size_t i) { static_assert(C == 1); return m[i][0]; }
+    //! Gets the element of a column vector
+    constexpr float operator[](size_t i) const { static_assert(C == 1); return m[i][0]; }
+
+    static constexpr Matrix Zero() { return {}; }
+
+    static constexpr Matrix Identity()
+    {
+        static_assert(R == C);
+        Matrix res = {};
+        for (size_t i = 0; i < R; i++)
+        {
+            res.m[i][i] = 1;
+        }
+        return res;
+    }
+
+    constexpr Matrix<C, R> Transpose() const
+    {
+        Matrix<C, R> res = {};
+        for (size_t r = 0; r < R; r++)
+        {
+            for (size_t c = 0; c < C; c++)
+            {
+                res.m[c][r] = m[r][c];
+            }
+        }
+        return res;
+    }
+
+    constexpr Matrix operator+(const Matrix& other) const
+    {
+        Matrix res = *this;
+        for (size_t r = 0; r < R; r++)
+        {
+            for (size_t c = 0; c < C; c++)
+            {
+                res.m[r][c] += other.m[r][c];
+            }
+        }
+        return res;
+    }
+
+    constexpr Matrix operator-(const Matrix& other) const
+    {
+        Matrix res = *this;
+        for (size_t r = 0; r < R; r++)
+        {
+            for (size_t c = 0; c < C; c++)
+            {
+                res.m[r][c] -= other.m[r][c];
+            }
+        }
+        return res;
+    }
+
+    constexpr Matrix operator*(float k) const
+    {
+        Matrix res = *this;
+        for (size_t r = 0; r < R; r++)
+        {
+            for (size_t c = 0; c < C; c++)
+            {
+                res.m[r][c] *= k;
+            }
+        }
+        return res;
+    }
+};
+
+template<size_t R, size_t N, size_t C> constexpr Matrix<R, C> operator*(const Matrix<R, N>& a, const Matrix<N, C>& b)
+{
+    Matrix<R, C> res = {};
+    for (size_t r = 0; r < R; r++)
+    {
+        for (size_t c = 0; c < C; c++)
+        {
+            float sum = 0;
+            for (size_t i = 0; i < N; i++)
+            {
+                sum += a.m[r][i] * b.m[i][c];
+            }
+            res.m[r][c] = sum;
+        }
+    }
+    return res;
+}
+
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/Navigation.cpp
+ */
+
+#include "Navigation.h"
+
+#include <math.h>
+
+#include <sensors/environment/util.h>
+
+namespace sensors::fusion
+{
+
+using position::LSM6DSOBase;
+
+static constexpr float DegToRad = float(M_PI / 180);
+static constexpr float Gravity = 9.80665f;
+static constexpr float InitialBiasVariance = 0.1f;
+
+void Navigation::Model(float dt)
+{
+    if (dt == modelDt)
+    {
+        return;
+    }
+
+    // position, velocity and bias driven by white acceleration noise and bias random walk
+    modelDt = dt;
+    float dt2 = dt * dt / 2;
+    float qa = settings.accelNoise * settings.accelNoise;
+
+    f3 = Matrix<3, 3>::Identity();
+    f3(Pos, Vel) = dt;
+    f3(Pos, Bias) = -dt2;
+    f3(Vel, Bias) = -dt;
+
+    q3 = {};
+    q3(Pos, Pos) = qa * dt2 * dt2;
+    q3(Pos, Vel) = q3(Vel, Pos) = qa * dt2 * dt;
+    q3(Vel, Vel) = qa * dt * dt;
+    q3(Bias, Bias) = settings.accelBiasDrift * settings.accelBiasDrift * dt;
+
+    f4 = Matrix<4, 4>::Identity();
+    q4 = {};
+    for (size_t r = 0; r < 3; r++)
+    {
+        for (size_t c = 0; c < 3; c++)
+        {
+            f4(r, c) = f3(r, c);
+            q4(r, c) = q3(r, c);
+        }
+    }
+    q4(BaroOffset, BaroOffset) = settings.baroDrift * settings.baroDrift * dt;
+}
+
+void Navigation::Predict(const XYZ& accel, float dt)
+{
+    if (!initialized)
+    {
+        return;
+    }
+
+    Model(dt);
+    float dt2 = dt * dt / 2;
+    north.Predict(f3, {{ { accel.x * dt2 }, { accel.x * dt }, { 0 } }}, q3);
+    west.Predict(f3, {{ { accel.y * dt2 }, { accel.y * dt }, { 0 } }}, q3);
+    up.Predict(f4, {{ { accel.z * dt2 }, { accel.z * dt }, { 0 }, { 0 } }}, q4);
+}
+
+size_t Navigation::Predict(const Quaternion& orientation, const LSM6DSOBase& imu, const LSM6DSOBase::FifoSample* samples, size_t count, float dt)
+{
+    if (!initialized)
+    {
+        return 0;
+    }
+
+    float q0 = orientation.w, q1 = orientation.x, q2 = orientation.y, q3 = orientation.z;
+    float sd = sinf(settings.declination * DegToRad), cd = cosf(settings.declination * DegToRad);
+    size_t n = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& smp = samples[i];
+        switch (smp.Tag())
+        {
+            case LSM6DSOBase::FifoTag::AccelNc: case LSM6DSOBase::FifoTag::AccelNcT1: case LSM6DSOBase::FifoTag::AccelNcT2:
+            {
+                auto a = imu.FifoSampleValue(smp);
+                // rotate to the magnetic earth frame, then to true north, and remove gravity
+                float x = a.x * (1 - 2 * (q2 * q2 + q3 * q3)) + 2 * a.y * (q1 * q2 - q0 * q3) + 2 * a.z * (q1 * q3 + q0 * q2);
+                float y = 2 * a.x * (q1 * q2 + q0 * q3) + a.y * (1 - 2 * (q1 * q1 + q3 * q3)) + 2 * a.z * (q2 * q3 - q0 * q1);
+                float z = 2 * a.x * (q1 * q3 - q0 * q2) + 2 * a.y * (q2 * q3 + q0 * q1) + a.z * (1 - 2 * (q1 * q1 + q2 * q2));
+                Predict({ (x * cd + y * sd) * Gravity, (y * cd - x * sd) * Gravity, (z - 1) * Gravity }, dt);
+                n++;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+    return n;
+}
+
+//! Gets the altitude above mean sea level, the one reported in @p ubx is preferred
+//! if it can be converted from the ellipsoid using the geoid separation
+static float MslAltitude(const gnss::LocationData& location, const gnss::UbxData* ubx)
+{
+    if (ubx && !isnan(ubx->altitude) && !isnan(location.separation))
+    {
+        return ubx->altitude - location.separation;
+    }
+    return location.altitude;
+}
+
+void Navigation::Initialize(const gnss::LocationData& location, float alt, float hVar, float vVar)
+{
+    lat0 = location.latitude;
+    lon0 = location.longitude;
+    alt0 = isnan(alt) ? 0 : alt;
+    metersPerDegLon = MetersPerDegree * cosf(float(lat0) * DegToRad);
+
+    Matrix<3, 3> p3 = {};
+    p3(Pos, Pos) = hVar;
+    p3(Vel, Vel) = InitialVariance;
+    p3(Bias, Bias) = InitialBiasVariance;
+    north.Reset({}, p3);
+    west.Reset({}, p3);
+
+    Matrix<4, 4> p4 = {};
+    p4(Pos, Pos) = isnan(vVar) ? InitialVariance : vVar;
+    p4(Vel, Vel) = InitialVariance;
+    p4(Bias, Bias) = InitialBiasVariance;
+    up.Reset({}, p4);
+
+    initialized = true;
+    baroInitialized = false;
+}
+
+bool Navigation::Update(const gnss::LocationData& location, const gnss::UbxData* ubx)
+{
+    if (isnan(location.latitude) || isnan(location.longitude))
+    {
+        return false;
+    }
+
+    if (ubx ? ubx->fixType == gnss::FixType::None || ubx->fixType == gnss::FixType::TimeOnly :
+        location.quality == 0 && location.status != 'A')
+    {
+        return false;
+    }
+
+    // accuracy estimates are preferred, DOP is the fallback
+    float hStd = ubx && ubx->hAcc > 0 ? ubx->hAcc : location.hdop * settings.uere;
+    float vStd = ubx && ubx->vAcc > 0 ? ubx->vAcc : location.vdop * settings.uere;
+    if (!(hStd > 0))
+    {
+        return false;
+    }
+    float hVar = hStd * hStd, vVar = vStd > 0 ? vStd * vStd : NAN;
+    float alt = MslAltitude(location, ubx);
+
+    bool res = true;
+    if (!initialized)
+    {
+        Initialize(location, alt, hVar, vVar);
+    }
+    else
+    {
+        double dLon = location.longitude - lon0;
+        if (dLon > 180) { dLon -= 360; }
+        else if (dLon < -180) { dLon += 360; }
+
+        bool resN = north.Update(Pos, float((location.latitude - lat0) * MetersPerDegree), hVar, settings.gate);
+        bool resW = west.Update(Pos, float(-dLon * metersPerDegLon), hVar, settings.gate);
+        res = resN && resW;
+
+        if (!isnan(alt) && !isnan(vVar))
+        {
+            up.Update(Pos, alt - alt0, vVar, settings.gate);
+        }
+    }
+
+    float speed = ubx && !isnan(ubx->groundSpeedKm) ? ubx->groundSpeedKm : location.groundSpeedKm;
+    float course = ubx && !isnan(ubx->course) ? ubx->course : location.course;
+    float velVar = settings.velocityNoise * settings.velocityNoise;
+    if (!isnan(speed) && !isnan(course))
+    {
+        speed /= 3.6f;
+        course *= DegToRad;
+        north.Update(Vel, speed * cosf(course), velVar, settings.gate);
+        west.Update(Vel, -speed * sinf(course), velVar, settings.gate);
+    }
+    if (ubx && !isnan(ubx->vVel))
+    {
+        // reported positive downwards
+        up.Update(Vel, -ubx->vVel, velVar, settings.gate);
+    }
+
+    return res;
+}
+
+bool Navigation::UpdatePressure(float pressure, float qnh)
+{
+    if (!initialized || !(pressure > 0))
+    {
+        return false;
+    }
+
+    float alt = environment::PressureToAltitude(pressure, qnh) - alt0;
+    if (!baroInitialized)
+    {
+        // the offset absorbs the difference between the barometric and GNSS altitude
+        float r = settings.baroNoise * settings.baroNoise;
+        up.Reset(BaroOffset, alt - up[Pos], up.Variance(Pos) + r);
+        baroInitialized = true;
+        return true;
+    }
+
+    Matrix<1, 4> h = {{ { 1, 0, 0, 1 } }};
+    return up.Update(h, alt, settings.baroNoise * settings.baroNoise, settings.gate);
+}
+
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/fusion/Navigation.h
+ *
+ * Loosely coupled GNSS/IMU/barometer position and velocity estimation
+ *
+ * The acceleration rotated to the earth frame by @ref Ahrs drives the prediction
+ * at the IMU rate, GNSS fixes and barometric altitude correct it. The frame is
+ * the one of @ref Ahrs (x north, y west, z up) with the origin at the first fix.
+ * The axes are independent, each is a small Kalman filter with position, velocity
+ * and acceleration bias states, the vertical one also estimates the offset
+ * of the barometric altitude.
+ *
+ * As with @ref Ahrs, the cost of the prediction and the updates is not benchmarked
+ * by the library and has to be measured on the target at the selected IMU rate.
+ */
+
+#pragma once
+
+#include <sensors/gnss/events.h>
+
+#include "Ahrs.h"
+#include "Kalman.h"
+
+namespace sensors::fusion
+{
+
+class Navigation
+{
+public:
+    struct Settings
+    {
+        //! Standard deviation of the acceleration noise in m/s^2
+        float accelNoise;
+        //! Random walk of the acceleration bias in m/s^2 per sqrt(s)
+        float accelBiasDrift;
+        //! Standard deviation of the barometric altitude in m
+        float baroNoise;
+        //! Random walk of the barometric altitude offset (weather, temperature) in m per sqrt(s)
+        float baroDrift;
+        //! Standard deviation of the GNSS velocity in m/s
+        float velocityNoise;
+        //! Position error per unit of DOP in m, used when no accuracy estimate is available
+        float uere;
+        //! Magnetic declination in degrees (east positive), rotates the heading of @ref Ahrs to true north
+        float declination;
+        //! Measurements with innovation larger than this many standard deviations are rejected, zero disables the check
+        float gate;
+    };
+
+    Navigation(const Settings& settings)
+        : settings(settings) {}
+
+    //! Propagates the estimate by @p dt seconds using acceleration in the earth frame in m/s^2, without gravity
+    void Predict(const XYZ& accel, float dt);
+    //! Processes a block of entries read by @ref position::LSM6DSO::ReadFifo, running one prediction per
+    //! accelerometer entry; the orientation is considered constant over the block, so @ref Ahrs::Update
+    //! should be run on the same block first
+    //! @param dt accelerometer sampling period in seconds
+    //! @return the number of predictions performed
+    size_t Predict(const Quaternion& orientation, const position::LSM6DSOBase& imu,
+        const position::LSM6DSOBase::FifoSample* samples, size_t count, float dt);
+    //! Applies a GNSS fix, the first valid fix initializes the estimate; the altitude, accuracy
+    //! estimates, fix type and vertical velocity are taken from @p ubx when available
+    //! @return false if the fix is not valid or has been rejected
+    bool Update(const gnss::LocationData& location, const gnss::UbxData* ubx = NULL);
+    //! Applies a barometric pressure measurement, converted using @ref environment::PressureToAltitude
+    //! @return false if the estimate is not initialized yet or the measurement has been rejected
+    bool UpdatePressure(float pressure, float qnh);
+
+    //! Checks if the estimate has been initialized by a GNSS fix
+    bool IsValid() const { return initialized; }
+    //! Gets the position relative to the first fix in m
+    XYZ Position() const { return { north[Pos], west[Pos], up[Pos] }; }
+    //! Gets the velocity in m/s
+    XYZ Velocity() const { return { north[Vel], west[Vel], up[Vel] }; }
+    //! Gets the estimated latitude in degrees
+    double Latitude() const { return lat0 + north[Pos] / MetersPerDegree; }
+    //! Gets the estimated longitude in degrees
+    double Longitude() const { return lon0 - west[Pos] / metersPerDegLon; }
+    //! Gets the estimated altitude above mean sea level in m
+    float Altitude() const { return alt0 + up[Pos]; }
+
+    //! Discards the estimate, the next valid fix initializes it again
+    void Reset() { initialized = baroInitialized = false; }
+
+private:
+    static constexpr float MetersPerDegree = 111195;
+    static constexpr float InitialVariance = 100;
+
+    enum
+    {
+        Pos, Vel, Bias, BaroOffset,
+    };
+
+    Settings settings;
+    KalmanFilter<3> north, west;
+    KalmanFilter<4> up;
+    //! Origin of the frame, kept in double precision so that the offsets of
+    //! the fixes from it are not rounded to the float resolution of the degrees
+    double lat0, lon0;
+    float alt0, metersPerDegLon;
+    bool initialized = false, baroInitialized = false;
+
+    //! Transition and process noise for the last used sampling period
+    float modelDt = 0;
+    Matrix<3, 3> f3, q3;
+    Matrix<4, 4> f4, q4;
+
+    void Model(float dt);
+    void Initialize(const gnss::LocationData& location, float alt, float hVar, float vVar);
+};
+
+}
@@ -8,9 +8,12 @@
 
 #include "MaxM10.h"
 
+#define MYDBG(...)      DBGCL("MaxM10", __VA_ARGS__)
+
 namespace sensors::gnss
 {
 
+static constexpr NmeaCommand PollUbxPosition("PUBX,00");
 
 void MaxM10::OnMessage(io::Pipe::Iterator& message)
 {
@@ -52,18 +55,207 @@ void MaxM10::OnMessage(io::Pipe::Iterator& message)
 async(MaxM10::PollRequest)
 async_def()
 {
-    await(SendMessage, "PUBX,00");
+    SENSOR_FRAME_FIELDS(FrameSizes::PollRequest);
+    await(SendMessage, PollUbxPosition);
     activePoll = false;
 }
 async_end
 
-void MaxM10::OnIdle()
+void MaxM10::OnUbxMessage(uint8_t cls, uint8_t id, io::Pipe::Iterator& payload)
+{
+    if (cls == 0x01 && id == 0x61)
+    {
+        // UBX-NAV-EOE
+        EndEpoch();
+    }
+}
+
+void MaxM10::OnEpochEnd()
 {
-    NmeaGnssDevice::OnIdle();
+    NmeaGnssDevice::OnEpochEnd();
     stableData = data;
     requestPoll = true;
 }
 
+async(MaxM10::EnableEpochEndMessage, bool enable)
+async_def(
+    PACKED_UNALIGNED_STRUCT
+    {
+        uint8_t version, layers, reserved[2];
+        uint32_t key;
+        uint8_t value;
+    } valset;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::EnableEpochEndMessage);
+    // UBX-CFG-VALSET, RAM layer, CFG-MSGOUT-UBX_NAV_EOE_UART1
+    f.valset = { 0, 1, {}, 0x20910160, enable };
+    async_return(await(SendUbx, 0x06, 0x8A, Span(&f.valset, sizeof(f.valset))));
+}
+async_end
+
+async(MaxM10::NegotiateBaudRate, unsigned maxBaudRate)
+async_def(
+    int i;
+    unsigned current;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::NegotiateBaudRate);
+probe:
+    // look for the rate currently used by the receiver, starting with the last known one
+    f.current = 0;
+    if (baudRate && SetHostBaudRate(baudRate) && await(VerifyLink))
+    {
+        f.current = baudRate;
+    }
+
+    for (f.i = 0; !f.current && f.i < (int)countof(BaudRates); f.i++)
+    {
+        if (BaudRates[f.i] == baudRate)
+        {
+            continue;
+        }
+
+        if (!SetHostBaudRate(BaudRates[f.i]))
+        {
+            MYDBG("Host does not support %u baud", BaudRates[f.i]);
+            continue;
+        }
+
+        MYDBG("Probing %u baud...", BaudRates[f.i]);
+        if (await(VerifyLink))
+        {
+            f.current = BaudRates[f.i];
+        }
+    }
+
+    if (!f.current)
+    {
+        MYDBG("Receiver not responding at any baud rate");
+        async_return(baudRate = 0);
+    }
+
+    MYDBG("Receiver found at %u baud", f.current);
+    baudRate = f.current;
+
+    // escalate to the highest permitted rate, falling back to lower ones if the link does not work
+    for (f.i = countof(BaudRates) - 1; f.i >= 0 && BaudRates[f.i] > baudRate; f.i--)
+    {
+        if (BaudRates[f.i] > maxBaudRate)
+        {
+            continue;
+        }
+
+        if (await(SwitchBaudRate, baudRate, BaudRates[f.i]))
+        {
+            MYDBG("Switched to %u baud", BaudRates[f.i]);
+            baudRate = BaudRates[f.i];
+            break;
+        }
+
+        // the receiver may or may not have switched, find out which rate it is using
+        MYDBG("Link not working at %u baud", BaudRates[f.i]);
+        SetHostBaudRate(baudRate);
+        if (await(VerifyLink))
+        {
+            // receiver ignored the request, try a lower rate
+            continue;
+        }
+
+        // receiver switched but the link does not work, try to switch it back
+        if (await(SwitchBaudRate, BaudRates[f.i], baudRate))
+        {
+            continue;
+        }
+
+        MYDBG("Link lost, probing again");
+        goto probe;
+    }
+
+    async_return(baudRate);
+}
+async_end
+
+async(MaxM10::SwitchBaudRate, unsigned from, unsigned to)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::SwitchBaudRate);
+    // the request must leave at the old rate before the host is switched
+    SetHostBaudRate(from);
+    await(SetBaudRate, to);
+    await(TxIdle);
+    async_delay_ms(SwitchDelayMs);
+    SetHostBaudRate(to);
+    async_return(await(VerifyLink));
+}
+async_end
+
+async(MaxM10::VerifyLink)
+async_def(
+    Timeout timeout;
+    uint32_t messages, errors;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::VerifyLink);
+    f.timeout = Timeout::Milliseconds(VerifyTimeoutMs).MakeAbsolute();
+    f.messages = MessagesReceived();
+    f.errors = MessageErrors();
+
+    while (!f.timeout.Elapsed())
+    {
+        async_delay_ms(20);
+        if (MessagesReceived() - f.messages >= VerifyMessages)
+        {
+            async_return(true);
+        }
+        if (MessageErrors() - f.errors >= VerifyErrors)
+        {
+            break;
+        }
+    }
+
+    async_return(false);
+}
+async_end
+
+async(MaxM10::AutoBaudRate, unsigned maxBaudRate)
+async_def_sync()
+{
+    this->maxBaudRate = maxBaudRate;
+    if (!autoBaud)
+    {
+        autoBaud = true;
+        kernel::Task::Run(this, &MaxM10::BaudRateMonitor);
+    }
+}
+async_end
+
+async(MaxM10::BaudRateMonitor)
+async_def(
+    uint32_t messages;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::BaudRateMonitor);
+    for (;;)
+    {
+        if (!await(NegotiateBaudRate, maxBaudRate))
+        {
+            async_delay_ms(RetryDelayMs);
+            continue;
+        }
+
+        // watch for the link going silent, which is what a receiver reset looks like
+        do
+        {
+            f.messages = MessagesReceived();
+            async_delay_ms(LinkLossTimeoutMs);
+        } while (MessagesReceived() != f.messages);
+
+        MYDBG("No messages received at %u baud, renegotiating", baudRate);
+    }
+}
+async_end
+
 FixType MaxM10::ReadFixType(io::Pipe::Iterator& message)
 {
     char id[2];
@@ -84,4 +276,13 @@ FixType MaxM10::ReadFixType(io::Pipe::Iterator& message)
     }
 }
 
+#ifndef SENSOR_FRAME_BUDGET_MaxM10
+#define SENSOR_FRAME_BUDGET_MaxM10    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(MaxM10, PollRequest, MaxM10::FrameSizes::PollRequest);
+SENSOR_FRAME_CHECK(MaxM10, EnableEpochEndMessage, MaxM10::FrameSizes::EnableEpochEndMessage);
+SENSOR_FRAME_CHECK(MaxM10, NegotiateBaudRate, MaxM10::FrameSizes::NegotiateBaudRate);
+SENSOR_FRAME_CHECK(MaxM10, BaudRateMonitor, MaxM10::FrameSizes::BaudRateMonitor);
+
 }
@@ -23,22 +23,75 @@ public:
     {
     }
 
+    //! Baud rates supported by the receiver UART, in ascending order
+    static constexpr unsigned BaudRates[] = { 9600, 38400, 115200, 230400, 460800, 921600 };
+
+    //! Asks the receiver to switch its UART to the specified baud rate, the host side of the link is not changed
     async(SetBaudRate, unsigned baudRate) { return async_forward(SendMessageF, "PUBX,41,1,3,3,%u,0", baudRate); }
+    //! Detects the baud rate currently used by the receiver and switches both sides of the link
+    //! to the highest rate not exceeding @p maxBaudRate, which must be supported by the host.
+    //! Returns the resulting baud rate, zero if the receiver could not be found at any rate
+    async(NegotiateBaudRate, unsigned maxBaudRate = 460800);
+    //! Starts a background task that negotiates the baud rate and renegotiates it
+    //! whenever the link is lost, e.g. after the receiver is reset to its default rate
+    async(AutoBaudRate, unsigned maxBaudRate = 460800);
+    //! Gets the verified baud rate of the link, zero if unknown
+    unsigned BaudRate() const { return baudRate; }
+    //! Enables the UBX-NAV-EOE message on UART1, which marks the end of each navigation epoch
+    //! so that location is published immediately after the last message of the epoch
+    async(EnableEpochEndMessage, bool enable = true);
 
     const UbxData& ExtendedData() const { return stableData; }
 
 protected:
     virtual void OnMessage(io::Pipe::Iterator& message);
-    virtual void OnIdle();
+    virtual void OnUbxMessage(uint8_t cls, uint8_t id, io::Pipe::Iterator& payload);
+    virtual void OnEpochEnd();
+    //! Changes the baud rate of the host side of the link, must be implemented for baud rate negotiation
+    virtual bool SetHostBaudRate(unsigned baudRate) { return false; }
 
     async(PollRequest);
 
 private:
+    enum
+    {
+        //! Number of valid messages that confirm the link is working
+        VerifyMessages = 2,
+        //! Number of malformed messages that indicate a baud rate mismatch
+        VerifyErrors = 4,
+        //! How long to wait for messages at a specific rate, must cover at least two navigation epochs
+        VerifyTimeoutMs = 2500,
+        //! Time to let the last characters leave the UART and the receiver apply a new rate
+        SwitchDelayMs = 20,
+        //! No messages for this long are considered a lost link
+        LinkLossTimeoutMs = 3000,
+        //! Delay before retrying negotiation after it failed completely
+        RetryDelayMs = 1000,
+    };
+
     bool requestPoll = true;
     bool activePoll = false;
+    bool autoBaud = false;
+    unsigned baudRate = 0, maxBaudRate = 0;
     UbxData data = { NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, 0, FixType::Unknown, -1 }, stableData = data;
 
     FixType ReadFixType(io::Pipe::Iterator& message);
+
+    async(VerifyLink);
+    async(SwitchBaudRate, unsigned from, unsigned to);
+    async(BaudRateMonitor);
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry PollRequest = { FrameSize<>, NmeaDevice::FrameSizes::SendMessageF };
+        static constexpr FrameEntry EnableEpochEndMessage = { FrameSize<uint8_t[9]>, NmeaDevice::FrameSizes::SendUbx };
+        static constexpr FrameEntry VerifyLink = { FrameSize<Timeout, uint32_t, uint32_t>, 0 };
+        static constexpr FrameEntry SwitchBaudRate = { FrameSize<>, FrameMax(NmeaDevice::FrameSizes::SendMessageF, NmeaDevice::FrameSizes::TxIdle, VerifyLink) };
+        static constexpr FrameEntry NegotiateBaudRate = { FrameSize<int, unsigned>, FrameMax(VerifyLink, SwitchBaudRate) };
+        static constexpr FrameEntry BaudRateMonitor = { FrameSize<uint32_t>, NegotiateBaudRate };
+    };
 };
 
 }
@@ -10,6 +10,8 @@
 
 #include <kernel/kernel.h>
 
+#include <base/format.h>
+
 #define MYDBG(...)      DBGCL("NMEA", __VA_ARGS__)
 
 //#define NMEA_TRACE    1
@@ -26,117 +28,458 @@ namespace sensors::gnss
 async(NmeaDevice::Init)
 async_def_sync()
 {
-    kernel::Task::Run(this, &NmeaDevice::Receiver);
+    if (!sharedReceiver)
+    {
+        kernel::Task::Run(this, &NmeaDevice::Receiver);
+    }
 }
 async_end
 
 async(NmeaDevice::Receiver)
 async_def(size_t len)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Receiver);
     MYDBG("Starting receiver");
     for (;;)
     {
         // skip the last message
         rx.Advance(f.len);
+#if NMEA_STATS
+        stats.bytes += f.len;
+#endif
 
-        // skip to next '$', detect idle
-        auto res = await_catch(rx.RequireUntil, '$', Timeout::Milliseconds(10));
-        if (res.Success())
-        {
-            f.len = res.Value();
-        }
-        else
+        // wait for more data, detect idle
+        if (!await_catch(rx.Require, 1, Timeout::Milliseconds(IdleTimeoutMs)).Success())
         {
             OnIdle();
-            f.len = await(rx.RequireUntil, '$');
+            await(rx.Require, 1);
         }
-        rx.Advance(f.len);
-        // wait until the entire message is buffered
-        f.len = await(rx.RequireUntil, '\n');
 
-        uint8_t csum = 0;
-        auto iter = rx.Enumerate(f.len);
-        while (iter && *iter != '*')
+        // skip to the start of the next sentence or UBX frame
+        f.len = SkipToFrame(rx.Available());
+        if (f.len)
         {
-            csum ^= *iter;
-            ++iter;
+            continue;
         }
 
-        if (!iter)
+        if (uint8_t(*rx.Enumerate(1)) == UbxSync1)
         {
-            MYDBG("Invalid message - '*' not found");
+            if (!await_catch(rx.Require, UbxHeaderLength, Timeout::Milliseconds(UbxFrameTimeoutMs)).Success() ||
+                !(f.len = UbxFrameLength()))
+            {
+                // not a valid UBX header, skip the sync byte
+                f.len = 1;
+                continue;
+            }
+            // wait until the entire frame is buffered, a sync pair appearing in text
+            // may announce a frame that never arrives or does not even fit in the pipe
+            if (!await_catch(rx.Require, f.len, Timeout::Milliseconds(UbxFrameTimeoutMs)).Success())
+            {
+                MYDBG("UBX frame incomplete, resynchronizing");
+                rxErrors++;
+                f.len = 1;
+                continue;
+            }
+            // on checksum error, resynchronize right after the sync byte
+            f.len = ProcessUbx(f.len) ? f.len : 1;
             continue;
         }
 
-        if (iter.Available() != 5)
+        rx.Advance(1);
+#if NMEA_STATS
+        stats.bytes++;
+#endif
+        // wait until the entire message is buffered
+        f.len = await(rx.RequireUntil, '\n');
+        ProcessSentence(f.len);
+    }
+}
+async_end
+
+bool NmeaDevice::ProcessAvailable()
+{
+    bool consumed = false;
+
+    while (size_t avail = rx.Available())
+    {
+        if (size_t skip = SkipToFrame(avail))
         {
-            MYDBG("Invalid message - encountered '*' %d chars too early", iter.Available() - 5);
+            rx.Advance(skip);
+#if NMEA_STATS
+            stats.bytes += skip;
+#endif
+            consumed = true;
             continue;
         }
 
-        char chsumh = *++iter, chsuml = *++iter;
-        int csumh = parse_nibble(chsumh), csuml = parse_nibble(chsuml);
-        if (csumh < 0 || csuml < 0)
+        auto iter = rx.Enumerate(avail);
+        if (uint8_t(*iter) == UbxSync1)
         {
-            MYDBG("Invalid checksum character %c or %c", chsumh, chsuml);
+            size_t len = avail < UbxHeaderLength ? 0 : UbxFrameLength();
+            if (avail < UbxHeaderLength || (len && avail < len))
+            {
+                // incomplete header or frame, keep waiting unless it takes too long
+                if (!UbxStalled())
+                {
+                    break;
+                }
+                MYDBG("UBX frame incomplete, resynchronizing");
+                rxErrors++;
+                len = 1;
+            }
+            else if (!len || !ProcessUbx(len))
+            {
+                // invalid header or checksum, resynchronize right after the sync byte
+                len = 1;
+            }
+
+            ubxWaiting = false;
+            rx.Advance(len);
+#if NMEA_STATS
+            stats.bytes += len;
+#endif
+            consumed = true;
             continue;
         }
 
-        if ((csumh << 4 | csuml) != csum)
+        // find the end of the sentence, the length includes the terminating '\n'
+        // but not the leading '$', same as returned by RequireUntil
+        ++iter;
+        size_t len = 1;
+        while (iter && *iter != '\n')
         {
-            MYDBG("Checksum error - expected %02X, received %02X", csum, (csumh << 4 | csuml));
-            continue;
+            ++iter;
+            len++;
         }
-        ++iter;
-        if (!iter.Matches("\r\n"))
+
+        if (!iter)
         {
-            MYDBG("Invalid message - not terminated with CRLF");
-            continue;
+            if (avail > MaxProprietaryLength)
+            {
+                // no terminator where there should be one, skip the '$' so we don't get stuck on garbage
+                rx.Advance(1);
+#if NMEA_STATS
+                stats.bytes++;
+#endif
+                rxErrors++;
+                consumed = true;
+                continue;
+            }
+
+            // incomplete sentence
+            break;
         }
 
+        rx.Advance(1);
+        ProcessSentence(len);
+        rx.Advance(len);
+#if NMEA_STATS
+        stats.bytes += len + 1;
+#endif
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+size_t NmeaDevice::SkipToFrame(size_t avail)
+{
+    auto iter = rx.Enumerate(avail);
+    size_t skip = 0;
+    while (iter && *iter != '$' && uint8_t(*iter) != UbxSync1)
+    {
+        ++iter;
+        skip++;
+    }
+    return skip;
+}
+
+bool NmeaDevice::UbxStalled()
+{
+    mono_t now = MONO_CLOCKS;
+    if (!ubxWaiting)
+    {
+        ubxWaiting = true;
+        ubxWaitStart = now;
+        return false;
+    }
+    return mono_signed_t(now - ubxWaitStart) >= mono_signed_t(MonoFromMilliseconds(UbxFrameTimeoutMs));
+}
+
+size_t NmeaDevice::UbxFrameLength()
+{
+    PACKED_UNALIGNED_STRUCT
+    {
+        uint8_t sync1, sync2, cls, id;
+        uint16_t len;
+    } hdr;
+
+    auto iter = rx.Enumerate(UbxHeaderLength);
+    iter.Read(hdr);
+    size_t len = FROM_LE16(hdr.len);
+    if (hdr.sync2 != UbxSync2 || len > MaxUbxPayload)
+    {
+        return 0;
+    }
+    return UbxHeaderLength + len + 2;
+}
+
+bool NmeaDevice::ProcessUbx(size_t len)
+{
+    // Fletcher checksum over class, ID, length and payload
+    uint8_t cka = 0, ckb = 0;
+    auto iter = rx.Enumerate(len);
+    iter.Skip(2);
+    for (size_t i = 2; i < len - 2; i++)
+    {
+        cka += *iter;
+        ckb += cka;
+        ++iter;
+    }
+
+    uint8_t rcka = *iter, rckb = *++iter;
+    if (cka != rcka || ckb != rckb)
+    {
+        MYDBG("UBX checksum error - expected %02X%02X, received %02X%02X", cka, ckb, rcka, rckb);
+        rxErrors++;
+        return false;
+    }
+
+    iter = rx.Enumerate(len - 2);
+    iter.Skip(2);
+    uint8_t cls = *iter, id = *++iter;
+    iter.Skip(3);
+
+    MYTRACE("<< UBX %02X-%02X, %d bytes", cls, id, len - UbxHeaderLength - 2);
+
+    rxMessages++;
+    OnUbxMessage(cls, id, iter);
+    return true;
+}
+
+bool NmeaDevice::ProcessSentence(size_t len)
+{
+    uint8_t csum = 0;
+    auto iter = rx.Enumerate(len);
+    while (iter && *iter != '*')
+    {
+        csum ^= *iter;
+        ++iter;
+    }
+
+    if (!iter)
+    {
+        MYDBG("Invalid message - '*' not found");
+        rxErrors++;
+        return false;
+    }
+
+    if (iter.Available() != 5)
+    {
+        MYDBG("Invalid message - encountered '*' %d chars too early", iter.Available() - 5);
+        rxErrors++;
+        return false;
+    }
+
+    char chsumh = *++iter, chsuml = *++iter;
+    int csumh = parse_nibble(chsumh), csuml = parse_nibble(chsuml);
+    if (csumh < 0 || csuml < 0)
+    {
+        MYDBG("Invalid checksum character %c or %c", chsumh, chsuml);
+        rxErrors++;
+        return false;
+    }
+
+    if ((csumh << 4 | csuml) != csum)
+    {
+        MYDBG("Checksum error - expected %02X, received %02X", csum, (csumh << 4 | csuml));
+        rxErrors++;
+        return false;
+    }
+    ++iter;
+    if (!iter.Matches("\r\n"))
+    {
+        MYDBG("Invalid message - not terminated with CRLF");
+        rxErrors++;
+        return false;
+    }
+
 #if TRACE && NMEA_TRACE
-        DBGC("NMEA", "<< ");
-        for (auto s: rx.EnumerateSpans(f.len - 5))
+    DBGC("NMEA", "<< ");
+    for (auto s: rx.EnumerateSpans(len - 5))
+    {
+        _DBG("%b", s);
+    }
+    _DBGCHAR('\n');
+#endif
+
+    rxMessages++;
+    iter = rx.Enumerate(len - 5);
+#if NMEA_STATS
+    mono_t start = MONO_CLOCKS;
+    OnMessage(iter);
+    UpdateStatistics(rx.Enumerate(len - 5), len, MONO_CLOCKS - start);
+#else
+    OnMessage(iter);
+#endif
+
+    epochOpen = true;
+    if (epochEndSentence && MatchesSentenceId(rx.Enumerate(len - 5), epochEndSentence))
+    {
+        EndEpoch();
+    }
+    return true;
+}
+
+bool NmeaDevice::MatchesSentenceId(io::Pipe::Iterator message, const char* id)
+{
+    for (; *id; id++, ++message)
+    {
+        if (!message || *message != *id)
         {
-            _DBG("%b", s);
+            return false;
         }
-        _DBGCHAR('\n');
-#endif
+    }
+    return !message || *message == ',';
+}
 
-        iter = rx.Enumerate(f.len - 5);
-        OnMessage(iter);
+void NmeaDevice::EndEpoch()
+{
+    if (epochOpen)
+    {
+        epochOpen = false;
+        OnEpochEnd();
     }
 }
-async_end
+
+#if NMEA_STATS
+
+void NmeaDevice::UpdateStatistics(io::Pipe::Iterator message, size_t len, mono_t ticks)
+{
+    // sentences are identified by the first field, proprietary ones also by the message ID
+    char id[sizeof(SentenceStatistics::id)] = {};
+    bool proprietary = message && *message == 'P';
+    for (size_t i = 0; i < sizeof(id) - 1 && message; i++, ++message)
+    {
+        char c = *message;
+        if (c == ',' && !(proprietary && i < 5)) { break; }
+        id[i] = c;
+    }
+
+    for (auto& st : stats.sentences)
+    {
+        if (!st.count)
+        {
+            memcpy(st.id, id, sizeof(id));
+        }
+        else if (memcmp(st.id, id, sizeof(id)))
+        {
+            continue;
+        }
+
+        st.count++;
+        st.bytes += len;
+        st.ticks += ticks;
+        return;
+    }
+
+    MYTRACE("No statistics slot left for %s", id);
+}
+
+#endif
 
 async(NmeaDevice::SendMessageFV, Timeout timeout, const char* format, va_list va)
 async_def(
-    Timeout timeout;
-    io::PipePosition start;
-    uint8_t checksum;
+    char sentence[MaxSentenceLength];
+    uint8_t len;
 )
 {
-    f.timeout = timeout.MakeAbsolute();
+    SENSOR_FRAME_FIELDS(FrameSizes::SendMessageFV);
+    // the checksum is calculated while formatting, so the sentence can be written to the pipe at once
+    struct Builder
+    {
+        char* p;
+        char* end;
+        uint8_t checksum;
+    } b = { f.sentence + 1, f.sentence + sizeof(f.sentence) - 5, 0 };
 
-    await(tx.Write, "$", f.timeout);
-    f.start = tx.Position();
-    await(tx.WriteFV, timeout, format, va);
+    f.sentence[0] = '$';
+    size_t len = ::format([](void* context, char c)
+    {
+        auto& b = *(Builder*)context;
+        if (b.p < b.end)
+        {
+            *b.p++ = c;
+            b.checksum ^= c;
+        }
+    }, &b, format, va);
 
-#if NMEA_TRACE
-    DBGC("NMEA", ">> ");
-#endif
-    for (char c : tx.EnumerateFrom(f.start))
+    if (b.p - (f.sentence + 1) != ptrdiff_t(len))
     {
-        f.checksum ^= c;
-#if NMEA_TRACE
-        _DBGCHAR(c);
-#endif
+        MYDBG("Sentence too long: %d characters", len);
+        async_return(false);
     }
-#if NMEA_TRACE
-    _DBGCHAR('\n');
+
+    *b.p++ = '*';
+    *b.p++ = "0123456789ABCDEF"[b.checksum >> 4];
+    *b.p++ = "0123456789ABCDEF"[b.checksum & 15];
+    *b.p++ = '\r';
+    *b.p++ = '\n';
+    f.len = b.p - f.sentence;
+
+    async_return(await(SendSentence, Span(f.sentence, f.len), timeout));
+}
+async_end
+
+async(NmeaDevice::SendSentence, Span sentence, Timeout timeout)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::SendSentence);
+#if TRACE && NMEA_TRACE
+    DBGC("NMEA", ">> %b", sentence);
 #endif
+    async_return(await(tx.Write, sentence, timeout));
+}
+async_end
+
+async(NmeaDevice::SendUbx, uint8_t cls, uint8_t id, Span payload, Timeout timeout)
+async_def(
+    uint8_t frame[UbxHeaderLength + MaxUbxSendPayload + 2];
+    uint8_t len;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::SendUbx);
+    if (payload.Length() > MaxUbxSendPayload)
+    {
+        MYDBG("UBX payload too long: %d", payload.Length());
+        async_return(0);
+    }
+
+    f.frame[0] = UbxSync1;
+    f.frame[1] = UbxSync2;
+    f.frame[2] = cls;
+    f.frame[3] = id;
+    f.frame[4] = uint8_t(payload.Length());
+    f.frame[5] = uint8_t(payload.Length() >> 8);
+    memcpy(f.frame + UbxHeaderLength, payload.Pointer(), payload.Length());
+    f.len = UbxHeaderLength + payload.Length();
 
-    await(tx.WriteFTimeout, timeout, "*%02X\r\n", f.checksum);
+    {
+        // Fletcher checksum over class, ID, length and payload
+        uint8_t cka = 0, ckb = 0;
+        for (size_t i = 2; i < f.len; i++)
+        {
+            cka += f.frame[i];
+            ckb += cka;
+        }
+        f.frame[f.len++] = cka;
+        f.frame[f.len++] = ckb;
+    }
+
+#if TRACE && NMEA_TRACE
+    DBGC("NMEA", ">> UBX %02X-%02X %H\n", cls, id, payload);
+#endif
+    async_return(await(tx.Write, Span(f.frame, f.len), timeout));
 }
 async_end
 
@@ -221,4 +564,12 @@ float NmeaDevice::ReadFloat(io::Pipe::Iterator& message)
     return (float)dec.value / dec.divisor;
 }
 
+#ifndef SENSOR_FRAME_BUDGET_NmeaDevice
+#define SENSOR_FRAME_BUDGET_NmeaDevice    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(NmeaDevice, Receiver, NmeaDevice::FrameSizes::Receiver);
+SENSOR_FRAME_CHECK(NmeaDevice, SendMessageF, NmeaDevice::FrameSizes::SendMessageF);
+SENSOR_FRAME_CHECK(NmeaDevice, SendUbx, NmeaDevice::FrameSizes::SendUbx);
+
 }
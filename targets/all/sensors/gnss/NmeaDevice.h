@@ -13,11 +13,40 @@
 #include <kernel/kernel.h>
 #include <io/DuplexPipe.h>
 
+#include <sensors/FrameBudget.h>
+
 #include "types.h"
 
 namespace sensors::gnss
 {
 
+class NmeaReceiver;
+
+//! Constant NMEA sentence with framing and checksum prepared at compile time
+template<size_t N> struct NmeaCommand
+{
+    constexpr NmeaCommand(const char (&body)[N])
+    {
+        uint8_t checksum = 0;
+        data[0] = '$';
+        for (size_t i = 0; i < N - 1; i++)
+        {
+            data[i + 1] = body[i];
+            checksum ^= body[i];
+        }
+        data[N] = '*';
+        data[N + 1] = "0123456789ABCDEF"[checksum >> 4];
+        data[N + 2] = "0123456789ABCDEF"[checksum & 15];
+        data[N + 3] = '\r';
+        data[N + 4] = '\n';
+    }
+
+    //! Gets the complete sentence, ready to be transmitted
+    Span Sentence() const { return Span(data, sizeof(data)); }
+
+    char data[N + 5] = {};
+};
+
 class NmeaDevice
 {
 public:
@@ -29,13 +58,79 @@ public:
     //! Waits for all data to be sent
     async(TxIdle, Timeout timeout = Timeout::Infinite) { return async_forward(tx.Empty, timeout); }
 
+    //! Configures the sentence that closes each navigation epoch (e.g. "GNGGA"), so that
+    //! @ref OnEpochEnd is called as soon as it is received instead of after the receiver goes idle
+    //! @param id sentence identifier (the first field), must remain valid while in use, NULL to disable
+    void SetEpochEndSentence(const char* id) { epochEndSentence = id; }
+
+    //! Gets the number of valid messages received so far
+    uint32_t MessagesReceived() const { return rxMessages; }
+    //! Gets the number of malformed messages (bad framing or checksum) received so far
+    uint32_t MessageErrors() const { return rxErrors; }
+
+#if NMEA_STATS
+    enum
+    {
+        MaxStatisticsSentences = 16,
+    };
+
+    //! Receive statistics for a single sentence type
+    struct SentenceStatistics
+    {
+        //! Sentence identifier, i.e. the first field (e.g. GNRMC), including the message ID for proprietary sentences (e.g. PUBX,00)
+        char id[8];
+        //! Number of valid sentences received
+        uint32_t count;
+        //! Number of bytes in the sentences, including framing
+        uint32_t bytes;
+        //! Total time spent processing the sentences, in MONO_CLOCKS ticks
+        mono_t ticks;
+    };
+
+    //! Receive statistics, collected only when compiled with NMEA_STATS
+    struct Statistics
+    {
+        //! Total number of bytes consumed from the receive pipe
+        uint32_t bytes;
+        SentenceStatistics sentences[MaxStatisticsSentences];
+    };
+
+    //! Gets the receive statistics
+    const Statistics& GetStatistics() const { return stats; }
+#endif
+
 protected:
+    enum
+    {
+        //! Maximum length of a sentence including framing, as specified by NMEA 0183
+        MaxSentenceLength = 82,
+        //! Maximum length of a proprietary sentence (e.g. u-blox PUBX,00 is about 110 characters),
+        //! buffered data without a terminator is discarded only when it exceeds this length
+        MaxProprietaryLength = 128,
+        //! Time without incoming data after which @ref OnIdle is called
+        IdleTimeoutMs = 10,
+        //! Maximum length of a UBX payload that will be transmitted
+        MaxUbxSendPayload = 64,
+    };
+
     async(SendMessage, const char* msg) { return async_forward(SendMessageF, "%s", msg); }
+    template<size_t N> async(SendMessage, const NmeaCommand<N>& cmd, Timeout timeout = Timeout::Infinite) { return async_forward(SendSentence, cmd.Sentence(), timeout); }
     async(SendMessageF, const char* format, ...) async_def_va(SendMessageFV, format, Timeout::Infinite, format);
     async(SendMessageFTimeout, Timeout timeout, const char* format, ...) async_def_va(SendMessageFV, format, timeout, format);
     async(SendMessageFV, Timeout timeout, const char* format, va_list va);
-    virtual void OnIdle() {}
+    //! Sends a complete sentence, including framing and checksum
+    async(SendSentence, Span sentence, Timeout timeout = Timeout::Infinite);
+    //! Sends a binary UBX message, adding framing and checksum
+    async(SendUbx, uint8_t cls, uint8_t id, Span payload, Timeout timeout = Timeout::Infinite);
+    //! Ends the current navigation epoch, calling @ref OnEpochEnd if any sentence was received since the previous one
+    void EndEpoch();
+    //! Called when no data is received for @ref IdleTimeoutMs, ends the epoch by default
+    virtual void OnIdle() { EndEpoch(); }
+    //! Called once after all messages of a navigation epoch have been received
+    virtual void OnEpochEnd() {}
     virtual void OnMessage(io::Pipe::Iterator& message) {}
+    //! Called for every valid UBX message interleaved with the sentences
+    virtual void OnUbxMessage(uint8_t cls, uint8_t id, io::Pipe::Iterator& payload) {}
 
     #pragma region Message readout helpers
 
@@ -52,8 +147,50 @@ protected:
 private:
     io::PipeReader rx;
     io::PipeWriter tx;
+    uint32_t rxMessages = 0, rxErrors = 0;
+    //! Receiver serving this device instead of a dedicated task, see @ref NmeaReceiver
+    NmeaReceiver* sharedReceiver = nullptr;
+    NmeaDevice* nextDevice = nullptr;
+    const char* epochEndSentence = nullptr;
+    bool epochOpen = false;
+    //! An incomplete UBX frame is being waited for by @ref ProcessAvailable since @ref ubxWaitStart
+    bool ubxWaiting = false;
+    mono_t ubxWaitStart;
+
+    enum
+    {
+        UbxSync1 = 0xB5,
+        UbxSync2 = 0x62,
+        //! Sync, class, ID and length
+        UbxHeaderLength = 6,
+        //! Longer frames are considered invalid, they may not fit in the receive pipe
+        MaxUbxPayload = 256,
+        //! Time to wait for the rest of a UBX frame before the sync bytes are considered garbage
+        UbxFrameTimeoutMs = 500,
+    };
+#if NMEA_STATS
+    Statistics stats = {};
+
+    void UpdateStatistics(io::Pipe::Iterator message, size_t len, mono_t ticks);
+#endif
 
     async(Receiver);
+    //! Processes all complete sentences already buffered in the receive pipe without blocking
+    //! @return true if any data was consumed
+    bool ProcessAvailable();
+    //! Validates and dispatches a complete sentence of the specified length, starting after the '$'
+    bool ProcessSentence(size_t len);
+    //! Gets the number of bytes preceding the next sentence or UBX frame in the first @p avail bytes
+    size_t SkipToFrame(size_t avail);
+    //! Gets the total length of the UBX frame whose header is buffered, zero if the header is invalid
+    size_t UbxFrameLength();
+    //! Checks if an incomplete UBX frame has been waited for longer than @ref UbxFrameTimeoutMs
+    bool UbxStalled();
+    //! Validates and dispatches a complete buffered UBX frame
+    bool ProcessUbx(size_t len);
+    static bool MatchesSentenceId(io::Pipe::Iterator message, const char* id);
+
+    friend class NmeaReceiver;
 
     enum struct Signal
     {
@@ -63,6 +200,19 @@ private:
     Signal sig = {};
 
     DECLARE_FLAG_ENUM(Signal);
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Receiver = { FrameSize<size_t>, SENSOR_FRAME_BUS };    // io::PipeReader::Require
+        static constexpr FrameEntry SendSentence = { FrameSize<>, SENSOR_FRAME_BUS };    // io::PipeWriter::Write
+        static constexpr FrameEntry SendMessageFV = { FrameSize<char[MaxSentenceLength], uint8_t>, SendSentence };
+        //! the async_def_va frame of SendMessageF and SendMessageFTimeout keeps just the va_list
+        static constexpr FrameEntry SendMessageF = { FrameSize<va_list>, SendMessageFV };
+        static constexpr FrameEntry SendUbx = { FrameSize<uint8_t[UbxHeaderLength + MaxUbxSendPayload + 2], uint8_t>, SENSOR_FRAME_BUS };
+        static constexpr FrameEntry TxIdle = { FrameSize<>, SENSOR_FRAME_BUS };    // forwarded to io::PipeWriter::Empty
+    };
 };
 
 DEFINE_FLAG_ENUM(NmeaDevice::Signal);
@@ -58,7 +58,7 @@ void NmeaGnssDevice::OnMessage(io::Pipe::Iterator& message)
                 case ID("RMC"): // recommended minimum data (basic location, etc.)
                 {
                     data.source = this;
-                    data.time = ReadDecimal(message);
+                    UpdateTime(ReadDecimal(message));
                     data.status = ReadChar(message);
                     data.latitude = ReadDeg(message) * (ReadChar(message) == 'S' ? -1 : 1);
                     data.longitude = ReadDeg(message) * (ReadChar(message) == 'W' ? -1 : 1);
@@ -87,7 +87,7 @@ void NmeaGnssDevice::OnMessage(io::Pipe::Iterator& message)
 
                 case ID("GGA"): // fix data
                 {
-                    data.time = ReadDecimal(message);
+                    UpdateTime(ReadDecimal(message));
                     data.latitude = ReadDeg(message) * (ReadChar(message) == 'S' ? -1 : 1);
                     data.longitude = ReadDeg(message) * (ReadChar(message) == 'W' ? -1 : 1);
                     data.quality = ReadNum(message);
@@ -203,7 +203,17 @@ void NmeaGnssDevice::OnMessage(io::Pipe::Iterator& message)
 
 }
 
-void NmeaGnssDevice::OnIdle()
+void NmeaGnssDevice::UpdateTime(Time time)
+{
+    if (epochOnTimeChange && time != data.time)
+    {
+        // the data collected so far belongs to the previous epoch
+        EndEpoch();
+    }
+    data.time = time;
+}
+
+void NmeaGnssDevice::OnEpochEnd()
 {
     MYTRACE("---");
     if (memcmp(&this->stableData, &this->data, sizeof(LocationData)))
@@ -26,9 +26,15 @@ public:
 
     const LocationData& LastLocation() const { return stableData; }
 
+    //! Ends the epoch whenever a sentence carries a different time than the previous ones,
+    //! useful when the last sentence of the epoch is not known in advance; note that the change
+    //! is only seen when the first sentence of the next epoch arrives, i.e. a full epoch late,
+    //! unless the receiver pauses between epochs and the idle detection (@ref OnIdle) ends it first
+    void SetEpochOnTimeChange(bool enable) { epochOnTimeChange = enable; }
+
 protected:
     virtual void OnMessage(io::Pipe::Iterator& message);
-    virtual void OnIdle();
+    virtual void OnEpochEnd();
 
 private:
     enum {
@@ -47,7 +53,9 @@ private:
     SatelliteData sdata[MaxGsvGroups];
     SatelliteData sdataPending = {};
     uint8_t sdataPendLast, sdataPendTotal;
+    bool epochOnTimeChange = false;
 
+    void UpdateTime(Time time);
     void Update(const LocationData& data);
     void SaveSatelliteData(const SatelliteData& data);
 };
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/gnss/NmeaReceiver.cpp
+ */
+
+#include "NmeaReceiver.h"
+
+#define MYDBG(...)      DBGCL("NMEA", __VA_ARGS__)
+
+namespace sensors::gnss
+{
+
+void NmeaReceiver::Add(NmeaDevice& device)
+{
+    ASSERT(count < MaxDevices);
+    ASSERT(!device.sharedReceiver);
+
+    device.sharedReceiver = this;
+
+    // append to keep the devices in the order they were added
+    NmeaDevice** p = &first;
+    while (*p)
+    {
+        p = &(*p)->nextDevice;
+    }
+    *p = &device;
+    count++;
+}
+
+async(NmeaReceiver::Init)
+async_def_sync()
+{
+    if (!running)
+    {
+        running = true;
+        kernel::Task::Run(this, &NmeaReceiver::Receiver);
+    }
+}
+async_end
+
+async(NmeaReceiver::Receiver)
+async_def(mono_t next)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::Receiver);
+    MYDBG("Starting shared receiver for %d devices", count);
+    f.next = MONO_CLOCKS;
+    for (;;)
+    {
+        bool pending = false;
+        {
+            mono_t now = MONO_CLOCKS;
+            unsigned i = 0;
+            for (auto dev = first; dev; dev = dev->nextDevice, i++)
+            {
+                auto& st = state[i];
+                if (dev->ProcessAvailable())
+                {
+                    st.lastActivity = now;
+                    st.idle = false;
+                }
+                else if (!st.idle && now - st.lastActivity >= MonoFromMilliseconds(NmeaDevice::IdleTimeoutMs))
+                {
+                    st.idle = true;
+                    dev->OnIdle();
+                }
+                // incomplete frames and epochs waiting for the idle timeout need polling
+                pending |= !st.idle || dev->ubxWaiting || dev->rx.Available();
+            }
+        }
+
+        if (!pending && first)
+        {
+            // all devices are idle, block on the first one instead of polling
+            await_catch(first->rx.Require, 1, Timeout::Milliseconds(idlePollMs));
+            f.next = MONO_CLOCKS;
+            continue;
+        }
+
+        f.next += MonoFromMilliseconds(pollMs);
+        if (mono_signed_t(f.next - MONO_CLOCKS) < 0)
+        {
+            // running late, do not try to catch up
+            f.next = MONO_CLOCKS;
+        }
+        async_delay_until(f.next);
+    }
+}
+async_end
+
+#ifndef SENSOR_FRAME_BUDGET_NmeaReceiver
+#define SENSOR_FRAME_BUDGET_NmeaReceiver    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(NmeaReceiver, Receiver, NmeaReceiver::FrameSizes::Receiver);
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/gnss/NmeaReceiver.h
+ *
+ * Single task serving the receive side of multiple NMEA devices
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#include "NmeaDevice.h"
+
+namespace sensors::gnss
+{
+
+class NmeaReceiver
+{
+public:
+    //! Creates a receiver polling the attached devices at the specified interval while any of them has pending input
+    //! @param idlePollMs maximum time to block on the first device while all devices are idle, see @ref Add
+    NmeaReceiver(unsigned pollMs = 5, unsigned idlePollMs = 100)
+        : pollMs(pollMs), idlePollMs(idlePollMs) {}
+
+    //! Attaches a device to the receiver, must be called before the device is initialized
+    //! While all devices are idle, the receiver blocks on the reader of the first attached device,
+    //! which is served without delay, the others are picked up within the idle poll interval
+    void Add(NmeaDevice& device);
+
+    //! Starts the receiver task
+    async(Init);
+
+    //! Gets the number of attached devices
+    unsigned DeviceCount() const { return count; }
+
+private:
+    struct DeviceState
+    {
+        mono_t lastActivity;
+        bool idle;
+    };
+
+    enum
+    {
+        MaxDevices = 8,
+    };
+
+    unsigned pollMs, idlePollMs;
+    unsigned count = 0;
+    NmeaDevice* first = nullptr;
+    DeviceState state[MaxDevices] = {};
+    bool running = false;
+
+    async(Receiver);
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Receiver = { FrameSize<mono_t>, SENSOR_FRAME_BUS };    // io::PipeReader::Require
+    };
+};
+
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/gnss/NmeaReplay.cpp
+ */
+
+#include "NmeaReplay.h"
+
+#define MYDBG(...)      DBGCL("REPLAY", __VA_ARGS__)
+
+namespace sensors::gnss
+{
+
+async(NmeaReplay::Run, const NmeaDevice& device, Span capture, unsigned baudRate)
+async_def(
+    size_t offset, len;
+    mono_t start;
+    uint32_t messages, errors;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::Run);
+    if (!draining)
+    {
+        draining = true;
+        kernel::Task::Run(this, &NmeaReplay::DrainCommands);
+    }
+
+    report = {};
+    f.messages = device.MessagesReceived();
+    f.errors = device.MessageErrors();
+    f.start = MONO_CLOCKS;
+
+    MYDBG("Replaying %d bytes at %u baud", capture.Length(), baudRate);
+    for (f.offset = 0; f.offset < capture.Length(); f.offset += f.len)
+    {
+        f.len = std::min(size_t(ChunkSize), capture.Length() - f.offset);
+        await(input.Write, Span((const char*)capture.Pointer() + f.offset, f.len), Timeout::Infinite);
+
+        if (baudRate)
+        {
+            // 10 bits per byte with 8N1 framing
+            async_delay_until(f.start + MonoFromMicroseconds(uint64_t(f.offset + f.len) * 10000000 / baudRate));
+        }
+    }
+
+    // let the device consume everything and finish the last epoch
+    await(input.Empty, Timeout::Infinite);
+    async_delay_ms(FlushDelayMs);
+
+    report.duration = MONO_CLOCKS - f.start;
+    report.bytes = capture.Length();
+    report.sentences = device.MessagesReceived() - f.messages;
+    report.errors = device.MessageErrors() - f.errors;
+    async_return(report.sentences);
+}
+async_end
+
+async(NmeaReplay::DrainCommands)
+async_def(size_t len)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::DrainCommands);
+    for (;;)
+    {
+        f.len = await(commands.RequireUntil, '\n');
+#if TRACE
+        DBGC("REPLAY", ">> ");
+        for (auto s: commands.EnumerateSpans(f.len - 2))
+        {
+            _DBG("%b", s);
+        }
+        _DBGCHAR('\n');
+#endif
+        commands.Advance(f.len);
+        report.commands++;
+    }
+}
+async_end
+
+void NmeaReplay::PrintReport(const NmeaDevice& device) const
+{
+    unsigned us = MonoToMicroseconds(report.duration);
+    if (!us) { us = 1; }
+    DBGC("REPLAY", "%u bytes, %u sentences, %u errors, %u commands in %u us: %u sentences/s, %u bytes/s\n",
+        report.bytes, report.sentences, report.errors, report.commands, us,
+        unsigned(uint64_t(report.sentences) * 1000000 / us), unsigned(uint64_t(report.bytes) * 1000000 / us));
+
+#if NMEA_STATS
+    for (auto& st : device.GetStatistics().sentences)
+    {
+        if (!st.count) { break; }
+        DBGC("REPLAY", "  %s: %u x %u B, %u ns/sentence\n",
+            st.id, st.count, st.bytes / st.count,
+            unsigned(uint64_t(MonoToMicroseconds(st.ticks)) * 1000 / st.count));
+    }
+#endif
+}
+
+void NmeaReplay::PrintLocation(const LocationData& ld)
+{
+    DBGC("LOC", "%02d%02d%02d %02d:%02d:%02d.%02d %c%c%c %.7q %.7q %.1q %.2q %.1q q%d s%d/%d/%d/%d/%d h%.2q p%.2q v%.2q\n",
+        ld.date.d, ld.date.m, ld.date.y, ld.time.h, ld.time.m, ld.time.s, ld.time.hs,
+        ld.status ? ld.status : '-', ld.posMode ? ld.posMode : '-', ld.navStatus ? ld.navStatus : '-',
+        int(ld.latitude * 1e7f), int(ld.longitude * 1e7f), int(ld.altitude * 10),
+        int(ld.groundSpeedKm * 100), int(ld.course * 10),
+        ld.quality, ld.numSat, ld.lockSat, ld.trkSat, ld.visSat, ld.knownSat,
+        int(ld.hdop * 100), int(ld.pdop * 100), int(ld.vdop * 100));
+}
+
+#ifndef SENSOR_FRAME_BUDGET_NmeaReplay
+#define SENSOR_FRAME_BUDGET_NmeaReplay    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(NmeaReplay, Run, NmeaReplay::FrameSizes::Run);
+SENSOR_FRAME_CHECK(NmeaReplay, DrainCommands, NmeaReplay::FrameSizes::DrainCommands);
+
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * sensors/gnss/NmeaReplay.h
+ *
+ * Harness for feeding recorded NMEA/UBX captures through NMEA devices
+ * over in-memory pipes, used to evaluate parser changes and to size
+ * the UART/CPU budget for new receivers
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+#include <io/DuplexPipe.h>
+
+#include "NmeaGnssDevice.h"
+
+namespace sensors::gnss
+{
+
+class NmeaReplay
+{
+public:
+    //! Creates a harness around the pipes that replace the device UART
+    //! @param rx pipe from which the device receives, filled with the capture
+    //! @param tx pipe into which the device sends commands, drained by the harness
+    NmeaReplay(io::Pipe& rx, io::Pipe& tx)
+        : rx(rx), tx(tx), input(rx), commands(tx) {}
+
+    //! Gets the pipe to be passed to the device under test
+    io::DuplexPipe DevicePipe() const { return io::DuplexPipe(rx, tx); }
+
+    //! Feeds the capture to the device, which must be initialized with @ref DevicePipe
+    //! @param baudRate when non-zero, the bytes are paced as they would arrive over a UART
+    //! running at this rate (8N1), otherwise they are fed as fast as the device consumes them
+    async(Run, const NmeaDevice& device, Span capture, unsigned baudRate = 0);
+
+    //! Summary of the last run
+    struct Report
+    {
+        //! Number of bytes fed to the device
+        uint32_t bytes;
+        //! Number of valid sentences processed by the device
+        uint32_t sentences;
+        //! Number of malformed sentences rejected by the device
+        uint32_t errors;
+        //! Number of commands sent by the device during the run
+        uint32_t commands;
+        //! Duration of the run in MONO_CLOCKS ticks
+        mono_t duration;
+    };
+
+    //! Gets the summary of the last run
+    const Report& GetReport() const { return report; }
+    //! Prints the summary of the last run, including per-sentence statistics
+    //! if the device was compiled with NMEA_STATS
+    void PrintReport(const NmeaDevice& device) const;
+    //! Prints location data in a canonical single-line form suitable for golden comparison
+    static void PrintLocation(const LocationData& data);
+
+private:
+    enum
+    {
+        //! Number of bytes written to the pipe at once
+        ChunkSize = 64,
+        //! Time to wait after the capture is consumed to let the last epoch complete
+        FlushDelayMs = 50,
+    };
+
+    io::Pipe& rx;
+    io::Pipe& tx;
+    io::PipeWriter input;
+    io::PipeReader commands;
+    Report report = {};
+    bool draining = false;
+
+    async(DrainCommands);
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Run = { FrameSize<size_t, size_t, mono_t, uint32_t, uint32_t>, SENSOR_FRAME_BUS };    // io::PipeWriter::Write, io::PipeWriter::Empty
+        static constexpr FrameEntry DrainCommands = { FrameSize<size_t>, SENSOR_FRAME_BUS };    // io::PipeReader::RequireUntil
+    };
+};
+
+//! Wraps a GNSS device so that every published location is printed using @ref NmeaReplay::PrintLocation
+template<class TDevice> class NmeaReplayDevice : public TDevice
+{
+public:
+    using TDevice::TDevice;
+
+protected:
+    virtual void OnEpochEnd()
+    {
+        TDevice::OnEpochEnd();
+        auto& ld = this->LastLocation();
+        if (memcmp(&ld, &last, sizeof(LocationData)))
+        {
+            last = ld;
+            NmeaReplay::PrintLocation(ld);
+        }
+    }
+
+private:
+    LocationData last = {};
+};
+
+}
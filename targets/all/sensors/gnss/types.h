@@ -58,6 +58,8 @@ struct Time
     }
 
     constexpr uint32_t TotalSeconds() const { return h * 3600 + m * 60 + s; }
+    constexpr bool operator ==(const Time& other) const { return h == other.h && m == other.m && s == other.s && hs == other.hs; }
+    constexpr bool operator !=(const Time& other) const { return !(*this == other); }
 
     uint8_t h, m, s, hs;
 };
@@ -11,11 +11,13 @@
 namespace sensors::position
 {
 
-async(LIS3DH::InitImpl, InitConfig cfg)
+template<class TSensor> async(LIS3DHT<TSensor>::InitImpl, InitConfig cfg)
 async_def(
     uint8_t id;
+    uint8_t ctl[6];
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::InitImpl);
     MYDBG("Reading ID...");
 
     if (!await(ReadRegister, Register::ID, f.id))
@@ -29,11 +31,25 @@ async_def(
         async_return(false);
     }
 
+    // CTRL_REG1-6 are written in a single burst
+    static_assert(Map.Writable(Map.BurstAddress(Register::Control1), sizeof(f.ctl)));
+    ControlRegisters(cfg, f.ctl);
+
     if (!await(WriteRegister, Register::Control5, Control5::Reset) ||
-        !await(WriteRegister, Register::Control5, cfg.ctl5) ||
-        !await(WriteRegister, Register::Control4, cfg.ctl4) ||
         !await(WriteRegister, Register::FifoControl, cfg.fifo) ||
-        !await(WriteRegister, Register::Control1, cfg.ctl1))
+        !await(WriteRegister, Map.BurstAddress(Register::Control1), f.ctl))
+    {
+        async_return(false);
+    }
+
+    // the engine registers are not affected by the reboot, so after an MCU-only reset they may hold
+    // anything written before, the shadow copy is invalidated to force a write of the whole block
+    for (size_t i = 0; i < sizeof(engActual); i++)
+    {
+        ((uint8_t*)&engActual)[i] = ~((const uint8_t*)&engDesired)[i];
+    }
+
+    if (!await(UpdateRegisters, Map.BurstAddress(Register::Int1Config), engActual, engDesired, EngineVolatile))
     {
         async_return(false);
     }
@@ -44,21 +60,89 @@ async_def(
     auto scale = BYTES(4, 8, 16, 48)[scaleIndex];
     mul = scale * float(0.001f/64);
     MYDBG("Init complete, scaleIndex: %d, scale: %d, ID: %02X, CTL1: %02X, CTL4: %02X, CTL5: %02X, FIFO: %02X", scaleIndex, scale, f.id, cfg.ctl1, cfg.ctl4, cfg.ctl5, cfg.fifo);
+    SENSOR_STATS_COUNT(inits);
     async_return(init = true);
 }
 async_end
 
-async(LIS3DH::ReadFifo, Sample* buffer, size_t count)
+template<class TSensor> void LIS3DHT<TSensor>::ControlRegisters(const InitConfig& cfg, uint8_t (&ctl)[6]) const
+{
+    auto offset = [](Register reg) { return Map.Address(reg) - Map.Address(Register::Control1); };
+    ctl[0] = uint8_t(cfg.ctl1);
+    ctl[offset(Register::Control2)] = uint8_t(ctlEvents.ctl2);
+    ctl[offset(Register::Control3)] = uint8_t(ctlEvents.ctl3);
+    ctl[offset(Register::Control4)] = uint8_t(cfg.ctl4);
+    ctl[offset(Register::Control5)] = uint8_t(cfg.ctl5 | ctlEvents.ctl5);
+    ctl[offset(Register::Control6)] = uint8_t(ctlEvents.ctl6);
+}
+
+template<class TSensor> void LIS3DHT<TSensor>::ConfigureGenerator(Generator gen, GeneratorMode mode, AxisEvent events, uint8_t threshold, uint8_t duration,
+    bool highPass, bool latch, bool only4d)
+{
+    auto& g = engDesired.gen[int(gen)];
+    g.cfg = uint8_t(mode) | uint8_t(events);
+    g.ths = threshold & 0x7F;
+    g.duration = duration & 0x7F;
+
+    auto hp = gen == Generator::Generator1 ? Control2::HighPassInt1 : Control2::HighPassInt2;
+    auto lir = gen == Generator::Generator1 ? Control5::LatchInt1 : Control5::LatchInt2;
+    auto d4d = gen == Generator::Generator1 ? Control5::D4DInt1 : Control5::D4DInt2;
+    ctlEvents.ctl2 = highPass ? ctlEvents.ctl2 | hp : ctlEvents.ctl2 & ~hp;
+    ctlEvents.ctl5 = ctlEvents.ctl5 & ~(lir | d4d);
+    if (latch)
+    {
+        ctlEvents.ctl5 = ctlEvents.ctl5 | lir;
+    }
+    if (only4d)
+    {
+        ctlEvents.ctl5 = ctlEvents.ctl5 | d4d;
+    }
+}
+
+template<class TSensor> void LIS3DHT<TSensor>::RouteEvents(IntPin pin, Event events)
+{
+    if (pin == IntPin::Int1)
+    {
+        ASSERT(!(events & Event::Activity));
+        auto ctl3 = Control3(0);
+        if (!!(events & Event::Generator1)) { ctl3 = ctl3 | Control3::Generator1; }
+        if (!!(events & Event::Generator2)) { ctl3 = ctl3 | Control3::Generator2; }
+        if (!!(events & Event::Click)) { ctl3 = ctl3 | Control3::Click; }
+        if (!!(events & Event::DataReady)) { ctl3 = ctl3 | Control3::DataReady; }
+        if (!!(events & Event::FifoWatermark)) { ctl3 = ctl3 | Control3::FifoWatermark; }
+        if (!!(events & Event::FifoOverrun)) { ctl3 = ctl3 | Control3::FifoOverrun; }
+        ctlEvents.ctl3 = ctl3;
+    }
+    else
+    {
+        ASSERT(!(events & (Event::DataReady | Event::FifoWatermark | Event::FifoOverrun)));
+        auto ctl6 = ctlEvents.ctl6 & Control6::ActiveLow;
+        if (!!(events & Event::Generator1)) { ctl6 = ctl6 | Control6::Generator1; }
+        if (!!(events & Event::Generator2)) { ctl6 = ctl6 | Control6::Generator2; }
+        if (!!(events & Event::Click)) { ctl6 = ctl6 | Control6::Click; }
+        if (!!(events & Event::Activity)) { ctl6 = ctl6 | Control6::Activity; }
+        ctlEvents.ctl6 = ctl6;
+    }
+}
+
+template<class TSensor> async(LIS3DHT<TSensor>::ReadFifo, Sample* buffer, size_t count)
 async_def(
     FifoStatus stat;
     size_t count;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadFifo);
     if (count == 0 || !await(ReadRegister, Register::FifoStatus, f.stat) || f.stat.count == 0)
     {
         async_return(0);
     }
 
+    // the address wraps back to OUT_X_L after each sample, so a single sample must be readable in a burst
+    static_assert(Map.Readable(Register::Data, sizeof(Sample)));
+    if (f.stat.overrun)
+    {
+        SENSOR_STATS_COUNT(overruns);
+    }
     f.count = std::min(count, size_t(f.stat.count + f.stat.overrun));
     if (!await(ReadRegister, Register::Data, Buffer(buffer, f.count * sizeof(Sample))))
     {
@@ -69,4 +153,96 @@ async_def(
 }
 async_end
 
+template<class TSensor> async(LIS3DHT<TSensor>::ApplyConfiguration)
+async_def(
+    uint8_t ctl[6];
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ApplyConfiguration);
+    if (!init)
+    {
+        // the engines are configured by Init, which needs the initial configuration
+        async_return(false);
+    }
+
+    ControlRegisters(cfg, f.ctl);
+    if (!await(WriteRegister, Map.BurstAddress(Register::Control1), f.ctl) ||
+        !await(WriteRegister, Register::FifoControl, cfg.fifo) ||
+        !await(UpdateRegisters, Map.BurstAddress(Register::Int1Config), engActual, engDesired, EngineVolatile))
+    {
+        init = false;
+        async_return(false);
+    }
+
+    async_return(true);
+}
+async_end
+
+template<class TSensor> async(LIS3DHT<TSensor>::ReadEvents)
+async_def(
+    RegisterRead seq[3];
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadEvents);
+    if (!init)
+    {
+        async_return(0);
+    }
+
+    // reading the source registers releases the latched events
+    f.seq[0] = { uint8_t(Register::Int1Source), 1, &eventSource[0] };
+    f.seq[1] = { uint8_t(Register::Int2Source), 1, &eventSource[1] };
+    f.seq[2] = { uint8_t(Register::ClickSource), 1, &eventSource[2] };
+    if (!await(ReadSequence, f.seq))
+    {
+        async_return(0);
+    }
+
+    // IA bit of each source register
+    auto events = Event(0);
+    if (eventSource[0] & 0x40) { events = events | Event::Generator1; }
+    if (eventSource[1] & 0x40) { events = events | Event::Generator2; }
+    if (eventSource[2] & 0x40) { events = events | Event::Click; }
+    MYTRACE("events: %02X (%H)", events, Span(eventSource));
+    async_return(intptr_t(events));
+}
+async_end
+
+template<class TSensor> async(LIS3DHT<TSensor>::WaitForEvents, GPIOPin pin)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::WaitForEvents);
+    // the MCU sleeps until the pin becomes active, the polarity is selected by INT_POLARITY in CTRL_REG6
+    await(pin.WaitFor, !(ctlEvents.ctl6 & Control6::ActiveLow));
+    async_return(await(ReadEvents));
+}
+async_end
+
+template<class TSensor> async(LIS3DHT<TSensor>::WaitForActivity, GPIOPin pin)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::WaitForActivity);
+    // the activity output is active while the device is in the inactive state
+    await(pin.WaitFor, !!(ctlEvents.ctl6 & Control6::ActiveLow));
+    async_return(true);
+}
+async_end
+
+template class LIS3DHT<Sensor>;
+#if !SENSORS_NO_I2C && !SENSORS_NO_SPI
+template class LIS3DHT<StaticSensor<I2CSensor>>;
+template class LIS3DHT<StaticSensor<SPISensor>>;
+#endif
+
+#ifndef SENSOR_FRAME_BUDGET_LIS3DH
+#define SENSOR_FRAME_BUDGET_LIS3DH    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(LIS3DH, InitImpl, LIS3DH::FrameSizes::InitImpl);
+SENSOR_FRAME_CHECK(LIS3DH, ReadFifo, LIS3DH::FrameSizes::ReadFifo);
+SENSOR_FRAME_CHECK(LIS3DH, ApplyConfiguration, LIS3DH::FrameSizes::ApplyConfiguration);
+SENSOR_FRAME_CHECK(LIS3DH, ReadEvents, LIS3DH::FrameSizes::ReadEvents);
+SENSOR_FRAME_CHECK(LIS3DH, WaitForEvents, LIS3DH::FrameSizes::WaitForEvents);
+SENSOR_FRAME_CHECK(LIS3DH, WaitForActivity, LIS3DH::FrameSizes::WaitForActivity);
+
 }
@@ -8,14 +8,17 @@
 
 #pragma once
 
-#include <sensors/I2CSensor.h>
+#include <sensors/Sensor.h>
+#include <sensors/StaticSensor.h>
+#include <sensors/RegisterMap.h>
 
 #include <sensors/types.h>
 
 namespace sensors::position
 {
 
-class LIS3DH : I2CSensor
+//! Definitions shared by all @ref LIS3DHT variants
+class LIS3DHBase
 {
 public:
     enum struct Address : uint8_t
@@ -31,11 +34,6 @@ public:
         XYZ ToXYZ(float mul) const { return { x * mul, y * mul, z * mul }; }
     };
 
-    LIS3DH(bus::I2C i2c, Address address)
-        : I2CSensor(i2c, (uint8_t)address)
-    {
-    }
-
     enum Rate
     {
         RateOneShot = 0,
@@ -65,42 +63,113 @@ public:
         Resolution12bit = 2,
     };
 
-    //! Initializes the sensor
-    async(Init, Rate rate, Scale scale, Resolution res = Resolution10bit)
+    //! Sampling level, e.g. one of the levels selected by an @ref AdaptiveRate
+    struct RateLevel
     {
-        return async_forward(InitImpl, InitConfig(
-            Control1(rate) | Control1::DirectionAll | (res == Resolution8bit) * Control1::LowPower,
-            Control4(scale) | (res == Resolution12bit) * Control4::HighResolution,
-            (res != Resolution12bit) * Control5::FifoEnable,
-            FifoControl::ModeStream));
-    }
+        Rate rate;
+        //! FIFO watermark in samples (0-31)
+        uint8_t watermark;
+    };
 
-    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
-    async(Measure);
-    //! Retrieves fifo contents
-    template<size_t n> async(ReadFifo, Sample (&buffer)[n]) { return async_forward(ReadFifo, buffer, n); }
-    //! Retrieves fifo contents
-    async(ReadFifo, Sample* buffer, size_t count);
+    //! Events produced by the interrupt engines
+    enum struct Event : uint8_t
+    {
+        //! Interrupt generator 1 condition, see @ref ConfigureGenerator
+        Generator1 = 0x01,
+        //! Interrupt generator 2 condition, see @ref ConfigureGenerator
+        Generator2 = 0x02,
+        //! Single or double click, see @ref ConfigureClick
+        Click = 0x04,
+        //! Inactivity state, INT2 only, see @ref ConfigureActivity; not reported by @ref ReadEvents
+        Activity = 0x08,
+        //! New data available, INT1 only
+        DataReady = 0x10,
+        //! FIFO watermark reached, INT1 only
+        FifoWatermark = 0x20,
+        //! FIFO overrun, INT1 only
+        FifoOverrun = 0x40,
+    };
 
-    //! Gets the last measured acceleration values
-    XYZ GetAccelerationXYZ() const { return xyz; }
-    //! Gets the multiplier used to convert raw values
-    float GetRawMultiplier() const { return mul; }
-    //! Converts a raw sample to standard acceleration values
-    XYZ SampleToXYZ(const Sample& smp) const { return smp.ToXYZ(mul); }
+    DECLARE_FLAG_ENUM(Event);
 
-protected:
-    const char* DebugComponent() const { return "LIS3DH"; }
+    //! Interrupt pin
+    enum struct IntPin
+    {
+        Int1,
+        Int2,
+    };
 
-private:
+    //! Interrupt generator
+    enum struct Generator
+    {
+        Generator1,
+        Generator2,
+    };
+
+    //! Combination of the axis events of an interrupt generator, INTx_CFG AOI and 6D
+    enum struct GeneratorMode : uint8_t
+    {
+        //! Any of the enabled axis events, e.g. any axis above the threshold for motion detection
+        Or = 0x00,
+        //! All of the enabled axis events, e.g. all axes below the threshold for free-fall detection
+        And = 0x80,
+        //! Change of orientation (6D movement)
+        Movement6D = 0x40,
+        //! Device in a known orientation (6D position)
+        Position6D = 0xC0,
+    };
+
+    //! Axis events of an interrupt generator
+    enum struct AxisEvent : uint8_t
+    {
+        XLow = 0x01,
+        XHigh = 0x02,
+        YLow = 0x04,
+        YHigh = 0x08,
+        ZLow = 0x10,
+        ZHigh = 0x20,
+
+        AllLow = XLow | YLow | ZLow,
+        AllHigh = XHigh | YHigh | ZHigh,
+    };
+
+    DECLARE_FLAG_ENUM(AxisEvent);
+
+    //! Click detection axes
+    enum struct ClickAxis : uint8_t
+    {
+        XSingle = 0x01,
+        XDouble = 0x02,
+        YSingle = 0x04,
+        YDouble = 0x08,
+        ZSingle = 0x10,
+        ZDouble = 0x20,
+
+        AllSingle = XSingle | YSingle | ZSingle,
+        AllDouble = XDouble | YDouble | ZDouble,
+    };
+
+    DECLARE_FLAG_ENUM(ClickAxis);
+
+protected:
     enum struct Register : uint8_t
     {
         ID = 0x0F,
         Control1 = 0x20,
+        Control2 = 0x21,
+        Control3 = 0x22,
         Control4 = 0x23,
         Control5 = 0x24,
+        Control6 = 0x25,
+        Reference = 0x26,
         FifoControl = 0x2E,
         FifoStatus = 0x2F,
+        Int1Config = 0x30,
+        Int1Source = 0x31,
+        Int2Config = 0x34,
+        Int2Source = 0x35,
+        ClickConfig = 0x38,
+        ClickSource = 0x39,
 
         Data = 0xA8,    // read with auto-increment
     };
@@ -110,6 +179,25 @@ private:
         Valid = 0x33,
     };
 
+    static constexpr RegisterMap Map = RegisterMap(0x80, {
+        { 0x07, RegisterAccess::Read, 0, 7 },           // STATUS_REG_AUX, OUT_ADC1-3
+        { Register::ID, RegisterAccess::Read, uint8_t(IDValue::Valid) },
+        { 0x1E, RegisterAccess::ReadWrite, 0x10 },      // CTRL_REG0
+        { 0x1F, RegisterAccess::ReadWrite },            // TEMP_CFG_REG
+        { Register::Control1, RegisterAccess::ReadWrite, 0x07 },
+        { 0x21, RegisterAccess::ReadWrite, 0, 6 },      // CTRL_REG2-6, REFERENCE
+        { 0x27, RegisterAccess::Read, 0, 7 },           // STATUS_REG, OUT_X/Y/Z
+        { Register::FifoControl, RegisterAccess::ReadWrite },
+        { Register::FifoStatus, RegisterAccess::Read, 0x20 },
+        { 0x30, RegisterAccess::ReadWrite },            // INT1_CFG
+        { 0x31, RegisterAccess::Read },                 // INT1_SRC
+        { 0x32, RegisterAccess::ReadWrite, 0, 3 },      // INT1_THS, INT1_DURATION, INT2_CFG
+        { 0x35, RegisterAccess::Read },                 // INT2_SRC
+        { 0x36, RegisterAccess::ReadWrite, 0, 3 },      // INT2_THS, INT2_DURATION, CLICK_CFG
+        { 0x39, RegisterAccess::Read },                 // CLICK_SRC
+        { 0x3A, RegisterAccess::ReadWrite, 0, 6 },      // CLICK_THS, TIME_LIMIT/LATENCY/WINDOW, ACT_THS/DUR
+    });
+
     enum struct Control1 : uint8_t
     {
         DirectionX = 0x01,
@@ -129,6 +217,26 @@ private:
         Rate400Hz = 0x70,
         RateLP1600Hz = 0x80,
         RateMaximum = 0x90,
+
+        _RateMask = 0xF0,
+    };
+
+    enum struct Control2 : uint8_t
+    {
+        HighPassInt1 = 0x01,
+        HighPassInt2 = 0x02,
+        HighPassClick = 0x04,
+    };
+
+    //! INT1 routing
+    enum struct Control3 : uint8_t
+    {
+        FifoOverrun = 0x02,
+        FifoWatermark = 0x04,
+        DataReady = 0x10,
+        Generator2 = 0x20,
+        Generator1 = 0x40,
+        Click = 0x80,
     };
 
     enum struct Control4 : uint8_t
@@ -146,19 +254,40 @@ private:
 
     enum struct Control5 : uint8_t
     {
+        D4DInt2 = 0x01,
+        LatchInt2 = 0x02,
+        D4DInt1 = 0x04,
+        LatchInt1 = 0x08,
+
         FifoEnable = 0x40,
 
         Reset = 0x80,
     };
 
+    //! INT2 routing and polarity
+    enum struct Control6 : uint8_t
+    {
+        ActiveLow = 0x02,
+        Activity = 0x08,
+        Generator2 = 0x20,
+        Generator1 = 0x40,
+        Click = 0x80,
+    };
+
     enum struct FifoControl : uint8_t
     {
         ModeStream = 0x80,
+
+        _WatermarkMask = 0x1F,
     };
 
     DECLARE_FLAG_ENUM(Control1);
+    DECLARE_FLAG_ENUM(Control2);
+    DECLARE_FLAG_ENUM(Control3);
     DECLARE_FLAG_ENUM(Control4);
     DECLARE_FLAG_ENUM(Control5);
+    DECLARE_FLAG_ENUM(Control6);
+    DECLARE_FLAG_ENUM(FifoControl);
 
     struct FifoStatus
     {
@@ -185,16 +314,221 @@ private:
         };
     };
 
+    //! Interrupt engine bits of the control registers, combined with @ref InitConfig
+    struct EventControl
+    {
+        Control2 ctl2;
+        Control3 ctl3;
+        Control5 ctl5;
+        Control6 ctl6;
+    };
+
+    //! Interrupt generator registers, INTx_CFG - INTx_DURATION
+    struct GeneratorConfig
+    {
+        uint8_t cfg;
+        uint8_t src;
+        uint8_t ths;
+        uint8_t duration;
+    };
+
+    //! Interrupt engine registers, INT1_CFG - ACT_DUR
+    struct EngineConfig
+    {
+        GeneratorConfig gen[2];
+        uint8_t clickCfg;
+        uint8_t clickSrc;
+        uint8_t clickThs;
+        uint8_t timeLimit;
+        uint8_t timeLatency;
+        uint8_t timeWindow;
+        uint8_t actThs;
+        uint8_t actDur;
+    };
+
+    //! Source registers within @ref EngineConfig, never written
+    static constexpr uint32_t EngineVolatile = BIT(1) | BIT(5) | BIT(9);
+};
+
+DEFINE_FLAG_ENUM(LIS3DHBase::Event);
+DEFINE_FLAG_ENUM(LIS3DHBase::AxisEvent);
+DEFINE_FLAG_ENUM(LIS3DHBase::ClickAxis);
+DEFINE_FLAG_ENUM(LIS3DHBase::Control1);
+DEFINE_FLAG_ENUM(LIS3DHBase::Control2);
+DEFINE_FLAG_ENUM(LIS3DHBase::Control3);
+DEFINE_FLAG_ENUM(LIS3DHBase::Control4);
+DEFINE_FLAG_ENUM(LIS3DHBase::Control5);
+DEFINE_FLAG_ENUM(LIS3DHBase::Control6);
+DEFINE_FLAG_ENUM(LIS3DHBase::FifoControl);
+
+//! Driver for the LIS3DH, the @p TSensor base selects the transport,
+//! see @ref StaticSensor for alternatives to the runtime-selected @ref Sensor
+template<class TSensor = Sensor> class LIS3DHT : public LIS3DHBase, TSensor
+{
+    using TSensor::ReadRegister;
+    using TSensor::WriteRegister;
+    using TSensor::UpdateRegisters;
+    using TSensor::ReadSequence;
+    using TSensor::MYDBG;
+    using TSensor::MYTRACE;
+    using TSensor::RegisterFrameSize;
+#if SENSOR_STATS
+    using TSensor::Stats;
+#endif
+
+public:
+    LIS3DHT(bus::I2C i2c, Address address)
+        : TSensor(i2c, (uint8_t)address)
+    {
+    }
+
+    //! Creates the driver using SPI, all transfers use address auto-increment
+    LIS3DHT(bus::SPI spi, GPIOPin cs)
+        : TSensor(spi, cs, 0xC0, 0x40)
+    {
+    }
+
+#if !SENSORS_NO_I2C && !SENSORS_NO_SPI
+    //! Creates the driver on top of an externally owned interface, e.g. a @ref ReplayInterface,
+    //! available only with the runtime-selected @ref Sensor
+    template<class T = TSensor> LIS3DHT(Interface& interface)
+        : T(interface)
+    {
+    }
+#endif
+
+    //! Initializes the sensor
+    async(Init, Rate rate, Scale scale, Resolution res = Resolution10bit)
+    {
+        return async_forward(InitImpl, InitConfig(
+            Control1(rate) | Control1::DirectionAll | (res == Resolution8bit) * Control1::LowPower,
+            Control4(scale) | (res == Resolution12bit) * Control4::HighResolution,
+            (res != Resolution12bit) * Control5::FifoEnable,
+            FifoControl::ModeStream));
+    }
+
+    //! Configures an interrupt generator, thresholds are in units of 16, 32, 62 or 186 mg for
+    //! the 2, 4, 8 or 16 g scale respectively
+    //! @param threshold threshold (0-127)
+    //! @param duration minimum duration of the condition in samples (0-127)
+    //! @param highPass applies the high-pass filter to the data evaluated by the generator,
+    //! so that only changes of acceleration, not the gravity, are detected
+    //! @param latch keeps the event active until it is read by @ref ReadEvents
+    //! @param only4d ignores the Z axis in 6D modes
+    void ConfigureGenerator(Generator gen, GeneratorMode mode, AxisEvent events, uint8_t threshold, uint8_t duration = 0,
+        bool highPass = false, bool latch = true, bool only4d = false);
+    //! Configures click detection, the threshold uses the same units as @ref ConfigureGenerator
+    //! @param timeLimit maximum duration of a click in samples (0-127)
+    //! @param latency dead time after the first click of a double click in samples
+    //! @param window maximum time to the start of the second click of a double click in samples
+    //! @param latch keeps the event active until it is read by @ref ReadEvents
+    void ConfigureClick(ClickAxis axes, uint8_t threshold, uint8_t timeLimit, uint8_t latency = 0, uint8_t window = 0,
+        bool highPass = true, bool latch = true)
+    {
+        engDesired.clickCfg = uint8_t(axes);
+        engDesired.clickThs = (threshold & 0x7F) | (latch ? 0x80 : 0);
+        engDesired.timeLimit = timeLimit & 0x7F;
+        engDesired.timeLatency = latency;
+        engDesired.timeWindow = window;
+        ctlEvents.ctl2 = highPass ? ctlEvents.ctl2 | Control2::HighPassClick : ctlEvents.ctl2 & ~Control2::HighPassClick;
+    }
+    //! Configures the sleep-to-wake function: after @p duration samples below @p threshold the device
+    //! switches to 10 Hz low-power mode and returns to the configured rate when the threshold is exceeded,
+    //! the threshold uses the same units as @ref ConfigureGenerator
+    //! @param duration inactivity time in units of 8 samples
+    void ConfigureActivity(uint8_t threshold, uint8_t duration)
+    {
+        engDesired.actThs = threshold & 0x7F;
+        engDesired.actDur = duration;
+    }
+    //! Routes events to an interrupt pin, replacing the events previously routed to it
+    void RouteEvents(IntPin pin, Event events);
+    //! Switches to a different sampling level after @ref Init, the change is written by @ref ApplyConfiguration
+    void Configure(const RateLevel& level)
+    {
+        cfg.ctl1 = (cfg.ctl1 & ~Control1::_RateMask) | Control1(level.rate);
+        cfg.fifo = (cfg.fifo & ~FifoControl::_WatermarkMask) | FifoControl(level.watermark & 0x1F);
+    }
+    //! Selects the polarity of both interrupt pins, active high by default
+    void ConfigureInterruptPolarity(bool activeLow)
+    {
+        ctlEvents.ctl6 = activeLow ? ctlEvents.ctl6 | Control6::ActiveLow : ctlEvents.ctl6 & ~Control6::ActiveLow;
+    }
+
+    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
+    async(Measure);
+    //! Retrieves fifo contents
+    template<size_t n> async(ReadFifo, Sample (&buffer)[n]) { return async_forward(ReadFifo, buffer, n); }
+    //! Retrieves fifo contents
+    async(ReadFifo, Sample* buffer, size_t count);
+    //! Applies changes of the sampling level and interrupt engine configuration made after @ref Init
+    async(ApplyConfiguration);
+    //! Reads and clears the latched events, returns a combination of @ref Event flags,
+    //! the raw source registers are available through @ref GetGeneratorSource and @ref GetClickSource
+    async(ReadEvents);
+    //! Sleeps until an event is signalled on @p pin, which must be connected to the interrupt pin
+    //! to which the events are routed, and reads the events, see @ref ReadEvents
+    async(WaitForEvents, GPIOPin pin);
+    //! Sleeps until the device leaves the low-power inactive state, i.e. until it is moved,
+    //! @p pin must be connected to INT2 with @ref Event::Activity routed to it
+    async(WaitForActivity, GPIOPin pin);
+
+    //! Gets the raw INTx_SRC value of an interrupt generator captured by the last @ref ReadEvents
+    uint8_t GetGeneratorSource(Generator gen) const { return eventSource[int(gen)]; }
+    //! Gets the raw CLICK_SRC value captured by the last @ref ReadEvents
+    uint8_t GetClickSource() const { return eventSource[2]; }
+
+    //! Gets the last measured acceleration values
+    XYZ GetAccelerationXYZ() const { return xyz; }
+    //! Gets the multiplier used to convert raw values
+    float GetRawMultiplier() const { return mul; }
+    //! Converts a raw sample to standard acceleration values
+    XYZ SampleToXYZ(const Sample& smp) const { return smp.ToXYZ(mul); }
+
+#if SENSOR_STATS
+    //! Gets the bus transfer and measurement statistics
+    using TSensor::Statistics;
+#endif
+#if SENSOR_RECORD && !SENSORS_NO_I2C && !SENSORS_NO_SPI
+    //! Logs register transactions, see @ref BusRecorder, available only with the runtime-selected @ref Sensor
+    template<class T = TSensor> void Record(BusRecorder* recorder, uint8_t device) { T::Record(recorder, device); }
+#endif
+
+protected:
+    const char* DebugComponent() const { return "LIS3DH"; }
+
+private:
     async(InitImpl, InitConfig cfg);
+    //! Fills CTRL_REG1-6 from the initial configuration and the interrupt engine configuration
+    void ControlRegisters(const InitConfig& cfg, uint8_t (&ctl)[6]) const;
 
     bool init = false;
     InitConfig cfg;
+    EventControl ctlEvents = {};
+    EngineConfig engActual, engDesired = {};
+    //! INT1_SRC, INT2_SRC and CLICK_SRC captured by the last @ref ReadEvents
+    uint8_t eventSource[3] = {};
     float mul = NAN;
     XYZ xyz = { NAN, NAN, NAN };
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry InitImpl = { FrameSize<uint8_t, uint8_t[6]>, RegisterFrameSize };
+        static constexpr FrameEntry ReadFifo = { FrameSize<FifoStatus, size_t>, RegisterFrameSize };
+        static constexpr FrameEntry ApplyConfiguration = { FrameSize<uint8_t[6]>, RegisterFrameSize };
+        static constexpr FrameEntry ReadEvents = { FrameSize<RegisterRead[3]>, RegisterFrameSize };
+        static constexpr FrameEntry WaitForEvents = { FrameSize<>, FrameMax(SENSOR_FRAME_BUS, ReadEvents) };    // GPIOPin::WaitFor
+        static constexpr FrameEntry WaitForActivity = { FrameSize<>, SENSOR_FRAME_BUS };    // GPIOPin::WaitFor
+    };
 };
 
-DEFINE_FLAG_ENUM(LIS3DH::Control1);
-DEFINE_FLAG_ENUM(LIS3DH::Control4);
-DEFINE_FLAG_ENUM(LIS3DH::Control5);
+//! LIS3DH driver with the transport selected at runtime
+class LIS3DH : public LIS3DHT<>
+{
+public:
+    using LIS3DHT::LIS3DHT;
+};
 
 }
@@ -8,12 +8,22 @@
 
 #include "LIS3MD.h"
 
+#include <math.h>
+
 namespace sensors::position
 {
 
-async(LIS3MD::Init)
+//! Converts an offset to the little-endian raw value of the OFFSET registers
+static int16_t OffsetRaw(float value, float scale)
+{
+    float raw = roundf(value * scale);
+    return TO_LE16(int16_t(raw < -32768 ? -32768 : raw > 32767 ? 32767 : raw));
+}
+
+template<class TSensor> async(LIS3MDT<TSensor>::Init)
 async_def(IDValue id; Control2 ctl2;)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     MYDBG("Reading ID...");
     if (!await(ReadRegister, Register::ID, f.id))
     {
@@ -43,6 +53,9 @@ async_def(IDValue id; Control2 ctl2;)
         }
     } while (!!(f.ctl2 & Control2::Reset));
 
+    // the reset clears the offsets
+    offsetActual = {};
+
     if (!await(ReadRegister, Register::Control1, cfgActual))
     {
         async_return(false);
@@ -54,13 +67,15 @@ async_def(IDValue id; Control2 ctl2;)
     }
 
     MYDBG("Init complete");
+    SENSOR_STATS_COUNT(inits);
     async_return(init = true);
 }
 async_end
 
-async(LIS3MD::Configure, Config cfg)
+template<class TSensor> async(LIS3MDT<TSensor>::Configure, Config cfg)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Configure);
     cfgDesired.ctl1 = (Control1)cfg;
     cfgDesired.ctl2 = (Control2)((uint32_t)cfg >> 8);
     cfgDesired.ctl4 = (Control4)((uint32_t)cfg >> 16);
@@ -74,19 +89,41 @@ async_def()
 }
 async_end
 
-async(LIS3MD::UpdateConfiguration)
+template<class TSensor> async(LIS3MDT<TSensor>::SetOffset, float x, float y, float z)
 async_def()
 {
-    if (cfgActual.combined != cfgDesired.combined)
+    SENSOR_FRAME_FIELDS(FrameSizes::SetOffset);
+    offset = { x, y, z };
+
+    if (init && !await(UpdateConfiguration))
     {
-        if (!await(WriteRegister, Register::Control1, cfgDesired))
-        {
-            // need re-init
-            init = false;
-            async_return(false);
-        }
+        async_return(false);
+    }
+
+    async_return(true);
+}
+async_end
+
+template<class TSensor> async(LIS3MDT<TSensor>::UpdateConfiguration)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::UpdateConfiguration);
+    // offsets are in LSB of the scale being configured
+    float scale = 32768.0f / cfgDesired.GetScale();
+    offsetDesired = { OffsetRaw(offset.x, scale), OffsetRaw(offset.y, scale), OffsetRaw(offset.z, scale) };
+
+    if (!await(UpdateRegisters, Register::OffsetXL, offsetActual, offsetDesired))
+    {
+        init = false;
+        async_return(false);
+    }
 
-        cfgActual = cfgDesired;
+    // CTRL3 is volatile, the device returns to power down after each single conversion
+    if (!await(UpdateRegisters, Register::Control1, cfgActual, cfgDesired, BIT(2)))
+    {
+        // need re-init
+        init = false;
+        async_return(false);
     }
 
     mul = cfgActual.GetScale() / 32768.0f;
@@ -95,15 +132,22 @@ async_def()
 }
 async_end
 
-async(LIS3MD::Measure)
+template<class TSensor> async(LIS3MDT<TSensor>::Measure)
 async_def(
     PACKED_UNALIGNED_STRUCT
     {
         Status status;
         int16_t x, y, z;
     } data;
+#if SENSOR_STATS
+    mono_t start;
+#endif
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
     if (!init && !await(Init))
     {
         async_return(false);
@@ -144,8 +188,24 @@ async_def(
     y = int16_t(FROM_LE16(f.data.y)) * mul;
     z = int16_t(FROM_LE16(f.data.z)) * mul;
     MYDBG("new data: X=%.3q Y=%.3q Z=%.3q (%H)", int(x * 1000), int(y * 1000), int(z * 1000), Span(f.data));
+    SENSOR_STATS_MEASURE(f.start);
     async_return(true);
 }
 async_end
 
+template class LIS3MDT<Sensor>;
+#if !SENSORS_NO_I2C && !SENSORS_NO_SPI
+template class LIS3MDT<StaticSensor<I2CSensor>>;
+template class LIS3MDT<StaticSensor<SPISensor>>;
+#endif
+
+#ifndef SENSOR_FRAME_BUDGET_LIS3MD
+#define SENSOR_FRAME_BUDGET_LIS3MD    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(LIS3MD, Init, LIS3MD::FrameSizes::Init);
+SENSOR_FRAME_CHECK(LIS3MD, Configure, LIS3MD::FrameSizes::Configure);
+SENSOR_FRAME_CHECK(LIS3MD, SetOffset, LIS3MD::FrameSizes::SetOffset);
+SENSOR_FRAME_CHECK(LIS3MD, Measure, LIS3MD::FrameSizes::Measure);
+
 }
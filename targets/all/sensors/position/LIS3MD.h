@@ -8,12 +8,14 @@
 
 #pragma once
 
-#include <sensors/I2CSensor.h>
+#include <sensors/Sensor.h>
+#include <sensors/StaticSensor.h>
 
 namespace sensors::position
 {
 
-class LIS3MD : I2CSensor
+//! Definitions shared by all @ref LIS3MDT variants
+class LIS3MDBase
 {
 public:
     enum struct Address : uint8_t
@@ -58,31 +60,19 @@ public:
         PowerUltra = PowerXYUltra | PowerZUltra,
     };
 
-    LIS3MD(bus::I2C i2c, Address address)
-        : I2CSensor(i2c, (uint8_t)address)
-    {
-    }
-
-    //! Field intensity in X direction in gauss
-    float GetFieldX() const { return x; }
-    //! Field intensity in Y direction in gauss
-    float GetFieldY() const { return y; }
-    //! Field intensity in Z direction in gauss
-    float GetFieldZ() const { return z; }
-
-    //! Initializes the sensor
-    async(Init);
-    //! Updates sensor configuration
-    async(Configure, Config cfg);
-    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
-    async(Measure);
+    //! First output register and length for polling the sensor through a sensor hub (e.g. @ref LSM6DSO::HubSlave),
+    //! OUT_X_L with the auto-increment flag, followed by X/Y/Z as little-endian 16-bit values
+    static constexpr uint8_t HubOutputRegister = 0x28 | 0x80, HubOutputLength = 6;
+    //! Gets the multiplier converting raw output values to gauss for the specified Scale value of @ref Config
+    static constexpr float RawMultiplier(Config scale) { return 4.0f * (((uint32_t(scale) >> 13) & 3) + 1) / 32768; }
 
 protected:
-    const char* DebugComponent() const { return "LIS3MD"; }
-
-private:
     enum struct Register : uint8_t
     {
+        OffsetXL = 0x05, OffsetXH = 0x06,
+        OffsetYL = 0x07, OffsetYH = 0x08,
+        OffsetZL = 0x09, OffsetZH = 0x0A,
+
         ID = 0xF,
 
         Control1 = 0x20,
@@ -147,7 +137,84 @@ private:
     DECLARE_FLAG_ENUM(Status);
     DECLARE_FLAG_ENUM(Control2);
     DECLARE_FLAG_ENUM(Control3);
+};
+
+DEFINE_FLAG_ENUM(LIS3MDBase::Config);
+DEFINE_FLAG_ENUM(LIS3MDBase::Status);
+DEFINE_FLAG_ENUM(LIS3MDBase::Control2);
+DEFINE_FLAG_ENUM(LIS3MDBase::Control3);
+
+//! Driver for the LIS3MD, the @p TSensor base selects the transport,
+//! see @ref StaticSensor for alternatives to the runtime-selected @ref Sensor
+template<class TSensor = Sensor> class LIS3MDT : public LIS3MDBase, TSensor
+{
+    using TSensor::ReadRegister;
+    using TSensor::WriteRegister;
+    using TSensor::UpdateRegisters;
+    using TSensor::MYDBG;
+    using TSensor::RegisterFrameSize;
+#if SENSOR_STATS
+    using TSensor::Stats;
+#endif
+
+public:
+    LIS3MDT(bus::I2C i2c, Address address)
+        : TSensor(i2c, (uint8_t)address)
+    {
+    }
+
+    //! Creates the driver using SPI, all transfers use address auto-increment
+    LIS3MDT(bus::SPI spi, GPIOPin cs)
+        : TSensor(spi, cs, 0xC0, 0x40)
+    {
+    }
+
+#if !SENSORS_NO_I2C && !SENSORS_NO_SPI
+    //! Creates the driver on top of an externally owned interface, e.g. a @ref ReplayInterface,
+    //! available only with the runtime-selected @ref Sensor
+    template<class T = TSensor> LIS3MDT(Interface& interface)
+        : T(interface)
+    {
+    }
+#endif
+
+    //! Field intensity in X direction in gauss
+    float GetFieldX() const { return x; }
+    //! Field intensity in Y direction in gauss
+    float GetFieldY() const { return y; }
+    //! Field intensity in Z direction in gauss
+    float GetFieldZ() const { return z; }
+
+    //! Hard-iron offset in X direction in gauss, subtracted from the output by the sensor
+    float GetOffsetX() const { return offset.x; }
+    //! Hard-iron offset in Y direction in gauss, subtracted from the output by the sensor
+    float GetOffsetY() const { return offset.y; }
+    //! Hard-iron offset in Z direction in gauss, subtracted from the output by the sensor
+    float GetOffsetZ() const { return offset.z; }
 
+    //! Initializes the sensor
+    async(Init);
+    //! Updates sensor configuration
+    async(Configure, Config cfg);
+    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
+    async(Measure);
+    //! Sets the hard-iron offsets in gauss, which the sensor subtracts from all subsequent measurements,
+    //! the offsets are kept across reinitialization and changes of the scale
+    async(SetOffset, float x, float y, float z);
+
+#if SENSOR_STATS
+    //! Gets the bus transfer and measurement statistics
+    using TSensor::Statistics;
+#endif
+#if SENSOR_RECORD && !SENSORS_NO_I2C && !SENSORS_NO_SPI
+    //! Logs register transactions, see @ref BusRecorder, available only with the runtime-selected @ref Sensor
+    template<class T = TSensor> void Record(BusRecorder* recorder, uint8_t device) { T::Record(recorder, device); }
+#endif
+
+protected:
+    const char* DebugComponent() const { return "LIS3MD"; }
+
+private:
     async(UpdateConfiguration);
 
     bool init = false;
@@ -170,13 +237,37 @@ private:
         bool IsPowerDown() const { return !!(ctl3 & Control3::ModePowerDown); }
     } cfgActual, cfgDesired;
 
+    //! Contents of the OFFSET registers, little-endian in LSB of the current scale
+    struct
+    {
+        int16_t x, y, z;
+    } offsetActual = {}, offsetDesired = {};
+
+    struct
+    {
+        float x, y, z;
+    } offset = {};
+
     float x = NAN, y = NAN, z = NAN;
     float mul;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry UpdateConfiguration = { FrameSize<>, RegisterFrameSize };
+        static constexpr FrameEntry Init = { FrameSize<IDValue, Control2>, FrameMax(UpdateConfiguration, RegisterFrameSize) };
+        static constexpr FrameEntry Configure = { FrameSize<>, UpdateConfiguration };
+        static constexpr FrameEntry SetOffset = { FrameSize<>, UpdateConfiguration };
+        static constexpr FrameEntry Measure = { FrameSize<uint8_t[1 + 3 * sizeof(int16_t)], FrameStatsStart>, FrameMax(Init, RegisterFrameSize) };
+    };
 };
 
-DEFINE_FLAG_ENUM(LIS3MD::Config);
-DEFINE_FLAG_ENUM(LIS3MD::Status);
-DEFINE_FLAG_ENUM(LIS3MD::Control2);
-DEFINE_FLAG_ENUM(LIS3MD::Control3);
+//! LIS3MD driver with the transport selected at runtime
+class LIS3MD : public LIS3MDT<>
+{
+public:
+    using LIS3MDT::LIS3MDT;
+};
 
 }
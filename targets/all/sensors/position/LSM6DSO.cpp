@@ -8,12 +8,15 @@
 
 #include "LSM6DSO.h"
 
+#include <math.h>
+
 namespace sensors::position
 {
 
-async(LSM6DSO::Init)
+template<class TSensor> async(LSM6DSOT<TSensor>::Init)
 async_def(IDValue id; uint8_t d;)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     MYDBG("Reading ID...");
     if (!await(ReadRegister, Register::ID, f.id))
     {
@@ -43,15 +46,14 @@ async_def(IDValue id; uint8_t d;)
         }
     } while (f.d & 0x81);
 
-    if (!await(ReadRegister, Register::Control1, cfgActual))
-    {
-        async_return(false);
-    }
-
-    if (!await(ReadRegister, Register::FifoCtrl1, fifoActual))
-    {
-        async_return(false);
-    }
+    // registers are in their reset state now, no need to read them back
+    Map.ResetValues(Register::Control1, (uint8_t*)&cfgActual, sizeof(cfgActual));
+    Map.ResetValues(Register::FifoCtrl1, (uint8_t*)&fifoActual, sizeof(fifoActual));
+    Map.ResetValues(Register::TapCfg0, (uint8_t*)&eventActual, sizeof(eventActual));
+    Map.ResetValues(Register::XOfsUsr, (uint8_t*)offsetActual, sizeof(offsetActual));
+    EmbMap.ResetValues(EmbRegister::EmbFuncEnA, (uint8_t*)&embActual.enable, sizeof(embActual.enable));
+    EmbMap.ResetValues(EmbRegister::EmbFuncInt1, (uint8_t*)embActual.route, sizeof(embActual.route));
+    HubMap.ResetValues(HubRegister::MasterConfig, (uint8_t*)&hubActual, sizeof(hubActual));
 
     if (!await(UpdateConfiguration))
     {
@@ -60,26 +62,45 @@ async_def(IDValue id; uint8_t d;)
 
     MYDBG("Init complete");
     lastFifoTag = 0;
+    SENSOR_STATS_COUNT(inits);
     async_return(init = true);
 }
 async_end
 
-async(LSM6DSO::UpdateConfiguration)
+template<class TSensor> async(LSM6DSOT<TSensor>::UpdateConfiguration)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::UpdateConfiguration);
+    static_assert(Map.Writable(Register::Control1, sizeof(Config)));
+    static_assert(Map.Writable(Register::FifoCtrl1, sizeof(FifoConfig)));
+    static_assert(Map.Writable(Register::TapCfg0, sizeof(EventConfig)));
+    static_assert(Map.Writable(Register::XOfsUsr, sizeof(offsetDesired)));
+
+    // offsets go first, their weight and enable bit are part of the main configuration
+    if (Span(offsetActual) != Span(offsetDesired))
+    {
+        MYDBG("Updating accelerometer offset: %H > %H",
+            Span(offsetActual),
+            Span(offsetDesired));
+        if (!await(UpdateRegisters, Register::XOfsUsr, offsetActual, offsetDesired))
+        {
+            // need re-init
+            init = false;
+            async_return(false);
+        }
+    }
+
     if (Span(cfgActual) != Span(cfgDesired))
     {
         MYDBG("Updating configuration: %H > %H",
             Span(cfgActual),
             Span(cfgDesired));
-        if (!await(WriteRegister, Register::Control1, cfgDesired))
+        if (!await(UpdateRegisters, Register::Control1, cfgActual, cfgDesired))
         {
             // need re-init
             init = false;
             async_return(false);
         }
-
-        cfgActual = cfgDesired;
     }
 
     if (Span(fifoActual) != Span(fifoDesired))
@@ -87,14 +108,51 @@ async_def()
         MYDBG("Updating FIFO configuration: %H > %H",
             Span(fifoActual),
             Span(fifoDesired));
-        if (!await(WriteRegister, Register::FifoCtrl1, fifoDesired))
+        if (!await(UpdateRegisters, Register::FifoCtrl1, fifoActual, fifoDesired))
+        {
+            // need re-init
+            init = false;
+            async_return(false);
+        }
+    }
+
+    if (Span(eventActual) != Span(eventDesired))
+    {
+        MYDBG("Updating event configuration: %H > %H",
+            Span(eventActual),
+            Span(eventDesired));
+        if (!await(UpdateRegisters, Register::TapCfg0, eventActual, eventDesired))
+        {
+            // need re-init
+            init = false;
+            async_return(false);
+        }
+    }
+
+    if (Span(embActual) != Span(embDesired))
+    {
+        MYDBG("Updating embedded functions: %H > %H",
+            Span(embActual),
+            Span(embDesired));
+        if (!await(UpdateEmbedded))
         {
             // need re-init
             init = false;
             async_return(false);
         }
+    }
 
-        fifoActual = fifoDesired;
+    if (Span(hubActual) != Span(hubDesired))
+    {
+        MYDBG("Updating sensor hub: %H > %H",
+            Span(hubActual),
+            Span(hubDesired));
+        if (!await(UpdateHub))
+        {
+            // need re-init
+            init = false;
+            async_return(false);
+        }
     }
 
     amul = cfgActual.GetAccelerationScale() * 0x1p-14f;
@@ -104,26 +162,204 @@ async_def()
 }
 async_end
 
-async(LSM6DSO::Measure)
+template<class TSensor> async(LSM6DSOT<TSensor>::UpdateEmbedded)
 async_def(
-    PACKED_UNALIGNED_STRUCT
+    RegisterWrite seq[4];
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::UpdateEmbedded);
+    static_assert(EmbMap.Writable(EmbRegister::EmbFuncEnA, sizeof(EmbeddedConfig::enable)));
+    static_assert(EmbMap.Writable(EmbRegister::EmbFuncInt1, sizeof(EmbeddedConfig::route)));
+
+    f.seq[0] = { uint8_t(Register::FuncCfgAddress), 1, &EmbeddedBank };
+    f.seq[1] = { uint8_t(EmbRegister::EmbFuncEnA), sizeof(embDesired.enable), &embDesired.enable };
+    f.seq[2] = { uint8_t(EmbRegister::EmbFuncInt1), sizeof(embDesired.route), embDesired.route };
+    f.seq[3] = { uint8_t(Register::FuncCfgAddress), 1, &MainBank };
+    if (!await(WriteSequence, f.seq))
     {
-        Status status;
-        uint8_t resvd;
-        int16_t temp;
-        int16_t gx, gy, gz;
-        int16_t ax, ay, az;
-    } data;
+        await(WriteRegister, Register::FuncCfgAddress, MainBank);
+        async_return(false);
+    }
+
+    embActual = embDesired;
+    async_return(true);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::UpdateHub)
+async_def(
+    RegisterWrite seq[4];
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::UpdateHub);
+    static_assert(HubMap.Writable(HubRegister::MasterConfig, sizeof(HubConfig)));
+
+    // the slaves are configured first so that the master starts with a complete configuration
+    f.seq[0] = { uint8_t(Register::FuncCfgAddress), 1, &SensorHubBank };
+    f.seq[1] = { uint8_t(HubRegister::Slv0Add), sizeof(hubDesired.slv), hubDesired.slv };
+    f.seq[2] = { uint8_t(HubRegister::MasterConfig), 1, &hubDesired.master };
+    f.seq[3] = { uint8_t(Register::FuncCfgAddress), 1, &MainBank };
+    if (!await(WriteSequence, f.seq))
+    {
+        await(WriteRegister, Register::FuncCfgAddress, MainBank);
+        async_return(false);
+    }
+
+    hubActual = hubDesired;
+    async_return(true);
+}
+async_end
+
+void LSM6DSOBase::RouteEvents(IntPin pin, Event events, uint8_t mlc)
+{
+    auto& route = embDesired.route[int(pin)];
+    route.emb = uint32_t(events & Event::_EmbeddedMask) >> 8;
+    route.fsmA = uint32_t(events) >> 16;
+    route.fsmB = uint32_t(events) >> 24;
+    route.mlc = mlc;
+
+    // MDx_CFG: INTx_EMB_FUNC, INTx_6D, INTx_DOUBLE_TAP, INTx_FF, INTx_WU, INTx_SINGLE_TAP, INTx_SLEEP_CHANGE
+    uint8_t md = 0;
+    if (route.emb || route.fsmA || route.fsmB || route.mlc) { md |= BIT(1); }
+    if (!!(events & Event::Orientation)) { md |= BIT(2); }
+    if (!!(events & Event::DoubleTap)) { md |= BIT(3); }
+    if (!!(events & Event::FreeFall)) { md |= BIT(4); }
+    if (!!(events & Event::WakeUp)) { md |= BIT(5); }
+    if (!!(events & Event::SingleTap)) { md |= BIT(6); }
+    if (!!(events & Event::SleepChange)) { md |= BIT(7); }
+    eventDesired.md[int(pin)] = md;
+
+    if (!!(events & Event::_BasicMask))
+    {
+        // keep the pin asserted until the sources are read by ReadEvents
+        eventDesired.latch = eventDesired.clearOnRead = true;
+        eventDesired.interruptsEnable = true;
+    }
+}
+
+void LSM6DSOBase::ConfigureAccelOffset(float x, float y, float z)
+{
+    // USR_OFF_W selects 2^-10 g or 2^-6 g per LSB, the finer one is used whenever the offset fits
+    bool coarse = fmaxf(fabsf(x), fmaxf(fabsf(y), fabsf(z))) > 127 * 0x1p-10f;
+    float scale = coarse ? 0x1p6f : 0x1p10f;
+    float v[3] = { x, y, z };
+    for (unsigned i = 0; i < 3; i++)
+    {
+        float raw = roundf(v[i] * scale);
+        offsetDesired[i] = int8_t(raw < -127 ? -127 : raw > 127 ? 127 : raw);
+    }
+    cfgDesired.accellUsrOffWeight = coarse;
+    cfgDesired.accelUsrOffEnable = offsetDesired[0] || offsetDesired[1] || offsetDesired[2];
+}
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ReadRegisterRecover, Register reg, Buffer buf)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadRegisterRecover);
+    if (await(ReadRegister, reg, buf))
+    {
+        async_return(true);
+    }
+
+    // a single glitch on the bus, repeat the transaction
+    if (await(ReadRegister, reg, buf))
+    {
+        SENSOR_STATS_COUNT(retries);
+        async_return(true);
+    }
+
+    async_return(await(Recover) && await(ReadRegister, reg, buf));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::Recover)
+async_def(
+    IDValue id;
+    Config cfg;
+    FifoConfig fifo;
+    EventConfig event;
+    int8_t offset[3];
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::Recover);
+    if (await(ReadRegister, Register::ID, f.id) && f.id == IDValue::Valid &&
+        await(ReadRegister, Register::Control1, f.cfg) &&
+        await(ReadRegister, Register::FifoCtrl1, f.fifo) &&
+        await(ReadRegister, Register::TapCfg0, f.event) &&
+        await(ReadRegister, Register::XOfsUsr, f.offset))
+    {
+        if (Span(f.cfg) == Span(cfgActual) && Span(f.fifo) == Span(fifoActual) && Span(f.event) == Span(eventActual) &&
+            Span(f.offset) == Span(offsetActual))
+        {
+            // the device kept its configuration, FIFO contents are preserved
+            MYDBG("Recovered, configuration intact");
+            SENSOR_STATS_COUNT(verified);
+            async_return(true);
+        }
+
+        // the configuration has been lost (e.g. brown-out), write it again without resetting
+        MYDBG("Restoring configuration: %H > %H", Span(f.cfg), Span(cfgActual));
+        cfgActual = f.cfg;
+        fifoActual = f.fifo;
+        eventActual = f.event;
+        memcpy(offsetActual, f.offset, sizeof(offsetActual));
+        // the embedded function and sensor hub banks are written again as well, loaded programs cannot be restored
+        memset(&embActual, 0, sizeof(embActual));
+        memset(&hubActual, 0, sizeof(hubActual));
+        if (await(UpdateConfiguration))
+        {
+            SENSOR_STATS_COUNT(restored);
+            async_return(true);
+        }
+    }
+
+    MYDBG("Recovery failed, reinitializing");
+    SENSOR_STATS_COUNT(resets);
+    init = false;
+    async_return(false);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::CountFifoLoss, size_t popped)
+async_def(
+    size_t popped;
+    uint16_t status;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::CountFifoLoss);
+#if SENSOR_STATS
+    f.popped = popped;
+    // the level may still be readable if only the configuration was lost
+    if (await(ReadRegister, Register::FifoStatus1, f.status))
+    {
+        f.popped += FROM_LE16(f.status) & 0x3FF;
+    }
+    SENSOR_STATS_ADD(dropped, f.popped);
+#endif
+    async_return(true);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::Measure)
+async_def(
+    MeasureData data;
+#if SENSOR_STATS
+    mono_t start;
+#endif
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
     if (!init && !await(Init))
     {
         async_return(false);
     }
 
-    if (!await(ReadRegister, Register::Status, f.data))
+    static_assert(Map.Readable(Register::Status, sizeof(f.data)));
+    if (!await(ReadRegisterRecover, Register::Status, f.data))
     {
-        init = false;
         async_return(false);
     }
 
@@ -138,10 +374,12 @@ async_def(
     gx = int16_t(FROM_LE16(f.data.gx)) * gmul;
     gy = int16_t(FROM_LE16(f.data.gy)) * gmul;
     gz = int16_t(FROM_LE16(f.data.gz)) * gmul;
+    temp = TemperatureValue(f.data.temp);
     MYTRACE("new data: aX=%.3q aY=%.3q aZ=%.3q gX=%.3q gY=%.3q gZ=%.3q (%H)",
         int(ax * 1000), int(ay * 1000), int(az * 1000),
         int(gx * 1000), int(gy * 1000), int(gz * 1000),
         Span(f.data));
+    SENSOR_STATS_MEASURE(f.start);
     async_return(true);
 
 }
@@ -155,7 +393,7 @@ static bool parity(uint8_t val)
     return val & 1;
 }
 
-async(LSM6DSO::FifoRead)
+template<class TSensor> async(LSM6DSOT<TSensor>::FifoRead)
 async_def(
     PACKED_UNALIGNED_STRUCT
     {
@@ -173,14 +411,26 @@ async_def(
     } data;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::FifoRead);
     if (!init && !await(Init))
     {
         async_return(0);
     }
 
+    static_assert(Map.Readable(Register::FifoOutTag, sizeof(f.data)));
+    static_assert(sizeof(f.data) == sizeof(FifoSample), "accounted as FifoSample in FrameSizes");
+    // reading FIFO_DATA_OUT pops the entry even if the transfer fails, so it is not repeated
     if (!await(ReadRegister, Register::FifoOutTag, f.data))
     {
-        init = false;
+        // Recover resets the driver on its own if the device cannot be restored
+        if (await(Recover))
+        {
+            SENSOR_STATS_COUNT(dropped);
+        }
+        else
+        {
+            await(CountFifoLoss, 1);
+        }
         async_return(0);
     }
 
@@ -197,6 +447,7 @@ async_def(
         if (parity(f.data.rawtag))
         {
             MYDBG("Fifo parity error: %X", f.data.rawtag);
+            SENSOR_STATS_COUNT(dropped);
             async_return(0);
         }
 
@@ -220,6 +471,10 @@ async_def(
                     Span(f.data));
                 break;
 
+            case FifoTag::Slave0: case FifoTag::Slave1: case FifoTag::Slave2: case FifoTag::Slave3:
+                MYTRACE("new hub data: slave %d (%H)", int(f.data.tag) - int(FifoTag::Slave0), Span(f.data));
+                break;
+
             default:
                 MYDBG("fifo?: %X %d %d %d %d %d", f.data.tag, f.data.tagCnt, f.data.tagParity, f.data.x, f.data.y, f.data.z);
                 break;
@@ -230,4 +485,434 @@ async_def(
 }
 async_end
 
+template<class TSensor> async(LSM6DSOT<TSensor>::ReadFifo, FifoSample* buffer, size_t count)
+async_def(
+    uint16_t status;
+    size_t count;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadFifo);
+    if (!init && !await(Init))
+    {
+        async_return(0);
+    }
+
+    if (count == 0)
+    {
+        async_return(0);
+    }
+
+    if (!await(ReadRegister, Register::FifoStatus1, f.status))
+    {
+        // nothing has been popped yet, the FIFO is drained on the next call
+        if (!await(Recover))
+        {
+            await(CountFifoLoss, 0);
+        }
+        async_return(0);
+    }
+
+    // FIFO_OVR_IA, older entries have been overwritten
+    if (FROM_LE16(f.status) & BIT(14))
+    {
+        SENSOR_STATS_COUNT(overruns);
+    }
+
+    // DIFF_FIFO, number of unread entries
+    f.count = std::min(count, size_t(FROM_LE16(f.status) & 0x3FF));
+    if (!f.count)
+    {
+        async_return(0);
+    }
+
+    // the address rolls back to FIFO_DATA_OUT_TAG after each entry, so the whole batch can be read in one burst
+    static_assert(Map.Readable(Register::FifoOutTag, sizeof(FifoSample)));
+    if (!await(ReadRegister, Register::FifoOutTag, Buffer(buffer, f.count * sizeof(FifoSample))))
+    {
+        // an unknown part of the batch has been popped, repeating the burst would return different data;
+        // the batch is lost, but the FIFO keeps running if the configuration survived
+        if (await(Recover))
+        {
+            SENSOR_STATS_ADD(dropped, f.count);
+        }
+        else
+        {
+            await(CountFifoLoss, f.count);
+        }
+        async_return(0);
+    }
+
+    lastFifoTag = buffer[f.count - 1].rawtag;
+    async_return(f.count);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::WriteBankRegisters, const FuncCfg& bank, uint8_t reg, Span data)
+async_def(
+    RegisterWrite seq[3];
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::WriteBankRegisters);
+    f.seq[0] = { uint8_t(Register::FuncCfgAddress), 1, &bank };
+    f.seq[1] = { uint8_t(reg), uint8_t(data.Length()), data.Pointer() };
+    f.seq[2] = { uint8_t(Register::FuncCfgAddress), 1, &MainBank };
+    if (!await(WriteSequence, f.seq))
+    {
+        // try not to leave the main bank hidden
+        await(WriteRegister, Register::FuncCfgAddress, MainBank);
+        async_return(false);
+    }
+
+    async_return(true);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ReadBankRegisters, const FuncCfg& bank, uint8_t reg, Buffer buf)
+async_def(
+    bool success;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadBankRegisters);
+    if (!await(WriteRegister, Register::FuncCfgAddress, bank))
+    {
+        async_return(false);
+    }
+
+    f.success = await(ReadRegister, reg, buf);
+    async_return(await(WriteRegister, Register::FuncCfgAddress, MainBank) && f.success);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::HubWrite, uint8_t address, uint8_t reg, uint8_t value)
+async_def(
+    HubSlaveConfig slv0;
+    uint8_t value;
+    MasterConfig master;
+    HubStatus status;
+    RegisterWrite seq[5];
+    int i;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::HubWrite);
+    if (!init && !await(Init))
+    {
+        async_return(false);
+    }
+
+    if (cfgActual.accelOdr == Odr::Disabled)
+    {
+        MYDBG("Sensor hub is triggered by the accelerometer, which is not running");
+        async_return(false);
+    }
+
+    // slave 0 performs a single write, the other slaves are disabled by AUX_SENS_ON = 0
+    static_assert(HubMap.Writable(HubRegister::Slv0Add, sizeof(HubSlaveConfig)));
+    f.slv0 = { uint8_t(address << 1), reg, 0 };
+    f.value = value;
+    f.master = MasterConfig::MasterOn | MasterConfig::WriteOnce;
+    f.seq[0] = { uint8_t(Register::FuncCfgAddress), 1, &SensorHubBank };
+    f.seq[1] = { uint8_t(HubRegister::Slv0Add), sizeof(f.slv0), &f.slv0 };
+    f.seq[2] = { uint8_t(HubRegister::DataWriteSlv0), 1, &f.value };
+    f.seq[3] = { uint8_t(HubRegister::MasterConfig), 1, &f.master };
+    f.seq[4] = { uint8_t(Register::FuncCfgAddress), 1, &MainBank };
+    MYDBG("Writing %02X to external sensor %02X register %02X", value, address, reg);
+    // the polling configuration of slave 0 is overwritten, the master is stopped until ConfigureHub
+    hubDesired.master = MasterConfig(0);
+    if (!await(WriteSequence, f.seq))
+    {
+        await(WriteRegister, Register::FuncCfgAddress, MainBank);
+        async_return(false);
+    }
+
+    hubActual.slv[0] = f.slv0;
+    hubActual.master = f.master;
+    for (f.i = 0; f.i < HubWriteAttempts; f.i++)
+    {
+        async_delay_ms(HubWritePollMs);
+        if (!await(ReadRegister, Register::StatusMaster, f.status))
+        {
+            async_return(false);
+        }
+        if (!!(f.status & (HubStatus::WriteOnceDone | HubStatus::Slave0Nack)))
+        {
+            break;
+        }
+    }
+
+    f.master = MasterConfig(0);
+    if (!await(WriteBankRegisters, SensorHubBank, uint8_t(HubRegister::MasterConfig), f.master))
+    {
+        async_return(false);
+    }
+    hubActual.master = f.master;
+
+    if (!(f.status & HubStatus::WriteOnceDone) || !!(f.status & HubStatus::Slave0Nack))
+    {
+        MYDBG("External sensor write failed, status: %02X", f.status);
+        async_return(false);
+    }
+
+    async_return(true);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ConfigureHub, const HubSlave* slaves, size_t count, HubOdr odr)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ConfigureHub);
+    ASSERT(count > 0 && count <= HubSlaves);
+
+    memset(&hubDesired, 0, sizeof(hubDesired));
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        // SLVx_CONFIG: number of bytes to read and BATCH_EXT_SENS_x_EN
+        ASSERT(slaves[i].length > 0 && slaves[i].length <= 7);
+        hubDesired.slv[i] = { uint8_t(slaves[i].address << 1 | 1), slaves[i].reg, uint8_t(slaves[i].length | BIT(3)) };
+        total += slaves[i].length;
+    }
+    // the output registers are filled by the slaves in order
+    ASSERT(total <= HubOutputSize);
+    // SHUB_ODR is in SLV0_CONFIG
+    hubDesired.slv[0].config |= uint8_t(odr) << 6;
+    hubDesired.master = MasterConfig::MasterOn | MasterConfig(count - 1);
+
+    // Init writes the whole configuration, including the sensor hub
+    if (!init && !await(Init))
+    {
+        async_return(false);
+    }
+
+    MYDBG("Configuring sensor hub: %H", Span(hubDesired));
+    async_return(Span(hubActual) == Span(hubDesired) || await(UpdateHub));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::DisableHub)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::DisableHub);
+    hubDesired.master = MasterConfig(0);
+    if (!init)
+    {
+        async_return(true);
+    }
+
+    async_return(await(UpdateHub));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ReadHub, unsigned slot, Buffer buf)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadHub);
+    ASSERT(slot < HubSlaves);
+
+    if (buf.Length() > HubLength(slot))
+    {
+        // the slave is not being polled, e.g. the device has not been initialized yet
+        async_return(false);
+    }
+
+    unsigned offset = 0;
+    for (unsigned i = 0; i < slot; i++)
+    {
+        offset += HubLength(i);
+    }
+
+    async_return(await(ReadBankRegisters, SensorHubBank, uint8_t(HubRegister::SensorHub1) + offset, buf));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ApplyConfiguration)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ApplyConfiguration);
+    if (!init)
+    {
+        async_return(await(Init));
+    }
+
+    async_return(await(UpdateConfiguration));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ReadEvents)
+async_def(
+    uint8_t src[5];
+    uint8_t emb[3];
+    RegisterRead seq[2];
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadEvents);
+    if (!init && !await(Init))
+    {
+        async_return(0);
+    }
+
+    // ALL_INT_SRC - STATUS_REG and EMB_FUNC_STATUS_MAINPAGE - FSM_STATUS_B_MAINPAGE,
+    // reading ALL_INT_SRC releases the latched interrupt pin
+    static_assert(Map.Readable(Register::AllIntSrc, sizeof(f.src)));
+    static_assert(Map.Readable(Register::EmbFuncStatus, sizeof(f.emb)));
+    f.seq[0] = { uint8_t(Register::AllIntSrc), sizeof(f.src), f.src };
+    f.seq[1] = { uint8_t(Register::EmbFuncStatus), sizeof(f.emb), f.emb };
+    if (!await(ReadSequence, f.seq))
+    {
+        async_return(0);
+    }
+
+    memcpy(eventSource, f.src + 1, sizeof(eventSource));
+    auto events = Event(f.src[0]) & Event::_BasicMask;
+    events |= Event(uint32_t(f.emb[0]) << 8) & Event::_EmbeddedMask;
+    events |= Event(uint32_t(f.emb[1]) << 16 | uint32_t(f.emb[2]) << 24);
+    MYTRACE("events: %X (%H %H)", events, Span(f.src), Span(f.emb));
+    async_return(intptr_t(events));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::WaitForEvents, GPIOPin pin)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::WaitForEvents);
+    // the MCU sleeps until the pin becomes active, the polarity is selected by H_LACTIVE in CTRL3
+    await(pin.WaitFor, !cfgActual.intActiveLow);
+    async_return(await(ReadEvents));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ReadStepCount, uint16_t& steps)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadStepCount);
+    if (!init && !await(Init))
+    {
+        async_return(false);
+    }
+
+    static_assert(EmbMap.Readable(EmbRegister::StepCounterL, sizeof(steps)));
+    if (!await(ReadBankRegisters, EmbeddedBank, uint8_t(EmbRegister::StepCounterL), steps))
+    {
+        async_return(false);
+    }
+
+    steps = FROM_LE16(steps);
+    async_return(true);
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ResetStepCount)
+async_def(
+    uint8_t src;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ResetStepCount);
+    if (!init && !await(Init))
+    {
+        async_return(false);
+    }
+
+    f.src = PedoRstStep;
+    async_return(await(WriteBankRegisters, EmbeddedBank, uint8_t(EmbRegister::EmbFuncSrc), f.src));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::ReadMlcResults, uint8_t (&results)[8])
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadMlcResults);
+    if (!init && !await(Init))
+    {
+        async_return(false);
+    }
+
+    static_assert(EmbMap.Readable(EmbRegister::Mlc0Src, sizeof(results)));
+    async_return(await(ReadBankRegisters, EmbeddedBank, uint8_t(EmbRegister::Mlc0Src), results));
+}
+async_end
+
+template<class TSensor> async(LSM6DSOT<TSensor>::LoadProgram, const UcfLine* program, size_t count)
+async_def(
+    size_t i;
+    RegisterRead seq[4];
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::LoadProgram);
+    if (!init && !await(Init))
+    {
+        async_return(false);
+    }
+
+    MYDBG("Loading program, %d lines", count);
+    for (f.i = 0; f.i < count; f.i++)
+    {
+        if (program[f.i].op == UcfLine::Op::Delay)
+        {
+            async_delay_ms(program[f.i].data);
+            continue;
+        }
+
+        if (!await(WriteRegister, program[f.i].address, program[f.i].data))
+        {
+            MYDBG("Program write %d failed", f.i);
+            // the device is left in an undefined state
+            init = false;
+            async_return(false);
+        }
+    }
+
+    // programs normally end in the main bank, but make sure
+    if (!await(WriteRegister, Register::FuncCfgAddress, MainBank))
+    {
+        init = false;
+        async_return(false);
+    }
+
+    // the program configures the main page and the embedded functions directly, adopt the result
+    f.seq[0] = { uint8_t(Register::Control1), sizeof(cfgActual), &cfgActual };
+    f.seq[1] = { uint8_t(Register::FifoCtrl1), sizeof(fifoActual), &fifoActual };
+    f.seq[2] = { uint8_t(Register::TapCfg0), sizeof(eventActual), &eventActual };
+    f.seq[3] = { uint8_t(Register::XOfsUsr), sizeof(offsetActual), offsetActual };
+    if (!await(ReadSequence, f.seq) ||
+        !await(ReadBankRegisters, EmbeddedBank, uint8_t(EmbRegister::EmbFuncEnA), embActual.enable) ||
+        !await(ReadBankRegisters, EmbeddedBank, uint8_t(EmbRegister::EmbFuncInt1), Buffer(embActual.route, sizeof(embActual.route))))
+    {
+        init = false;
+        async_return(false);
+    }
+
+    cfgDesired = cfgActual;
+    fifoDesired = fifoActual;
+    eventDesired = eventActual;
+    memcpy(offsetDesired, offsetActual, sizeof(offsetDesired));
+    embDesired = embActual;
+    MYDBG("Program loaded: %H %H %H %H", Span(cfgActual), Span(fifoActual), Span(eventActual), Span(embActual));
+    async_return(await(UpdateConfiguration));
+}
+async_end
+
+template class LSM6DSOT<Sensor>;
+#if !SENSORS_NO_I2C && !SENSORS_NO_SPI
+template class LSM6DSOT<StaticSensor<I2CSensor>>;
+template class LSM6DSOT<StaticSensor<SPISensor>>;
+#endif
+
+#ifndef SENSOR_FRAME_BUDGET_LSM6DSO
+#define SENSOR_FRAME_BUDGET_LSM6DSO    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(LSM6DSO, Init, LSM6DSO::FrameSizes::Init);
+SENSOR_FRAME_CHECK(LSM6DSO, Measure, LSM6DSO::FrameSizes::Measure);
+SENSOR_FRAME_CHECK(LSM6DSO, FifoRead, LSM6DSO::FrameSizes::FifoRead);
+SENSOR_FRAME_CHECK(LSM6DSO, ReadFifo, LSM6DSO::FrameSizes::ReadFifo);
+SENSOR_FRAME_CHECK(LSM6DSO, HubWrite, LSM6DSO::FrameSizes::HubWrite);
+SENSOR_FRAME_CHECK(LSM6DSO, ConfigureHub, LSM6DSO::FrameSizes::ConfigureHub);
+SENSOR_FRAME_CHECK(LSM6DSO, ReadHub, LSM6DSO::FrameSizes::ReadHub);
+SENSOR_FRAME_CHECK(LSM6DSO, ApplyConfiguration, LSM6DSO::FrameSizes::ApplyConfiguration);
+SENSOR_FRAME_CHECK(LSM6DSO, ReadEvents, LSM6DSO::FrameSizes::ReadEvents);
+SENSOR_FRAME_CHECK(LSM6DSO, WaitForEvents, LSM6DSO::FrameSizes::WaitForEvents);
+SENSOR_FRAME_CHECK(LSM6DSO, ReadStepCount, LSM6DSO::FrameSizes::ReadStepCount);
+SENSOR_FRAME_CHECK(LSM6DSO, ResetStepCount, LSM6DSO::FrameSizes::ResetStepCount);
+SENSOR_FRAME_CHECK(LSM6DSO, ReadMlcResults, LSM6DSO::FrameSizes::ReadMlcResults);
+SENSOR_FRAME_CHECK(LSM6DSO, LoadProgram, LSM6DSO::FrameSizes::LoadProgram);
+
 }
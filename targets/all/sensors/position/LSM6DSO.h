@@ -8,13 +8,16 @@
 
 #pragma once
 
-#include <sensors/I2CSensor.h>
+#include <sensors/Sensor.h>
+#include <sensors/StaticSensor.h>
+#include <sensors/RegisterMap.h>
 #include <math/Vector3.h>
 
 namespace sensors::position
 {
 
-class LSM6DSO : I2CSensor
+//! Definitions and bus-independent state shared by all @ref LSM6DSOT variants
+class LSM6DSOBase
 {
 public:
     enum struct Address : uint8_t
@@ -23,11 +26,6 @@ public:
         High = 0x6B,
     };
 
-    LSM6DSO(bus::I2C i2c, Address address)
-        : I2CSensor(i2c, (uint8_t)address)
-    {
-    }
-
     //! Accelerometer full-scale range
     enum struct AccelFs
     {
@@ -118,6 +116,164 @@ public:
         Nack = 0x19,
     };
 
+    //! Raw FIFO entry, as read by @ref ReadFifo
+    PACKED_UNALIGNED_STRUCT FifoSample
+    {
+        uint8_t rawtag;
+        int16_t x, y, z;
+
+        FifoTag Tag() const { return FifoTag(rawtag >> 3); }
+        //! Gets the sensor hub slave that produced the entry, -1 if the entry does not come from the sensor hub
+        int HubSlot() const { return Tag() >= FifoTag::Slave0 && Tag() <= FifoTag::Slave3 ? int(Tag()) - int(FifoTag::Slave0) : -1; }
+        //! Gets the raw data of a sensor hub entry, i.e. the first six bytes read from the external sensor
+        Span HubData() const { return Span(&x, 6); }
+    };
+
+    //! Rate at which the sensor hub polls external sensors, never faster than the accelerometer output data rate
+    enum struct HubOdr
+    {
+        Odr104Hz = 0,
+        Odr52Hz = 1,
+        Odr26Hz = 2,
+        Odr12p5Hz = 3,
+    };
+
+    //! External sensor on the auxiliary I2C bus polled by the sensor hub
+    struct HubSlave
+    {
+        //! 7-bit I2C address of the external sensor
+        uint8_t address;
+        //! First register read in each cycle, including the auto-increment flag if the sensor needs one
+        uint8_t reg;
+        //! Number of bytes read in each cycle, only the first six are batched in the FIFO
+        uint8_t length;
+    };
+
+    //! Events reported by the motion engines, as returned by @ref ReadEvents
+    enum struct Event : uint32_t
+    {
+        // ALL_INT_SRC
+        FreeFall = 0x01,
+        WakeUp = 0x02,
+        SingleTap = 0x04,
+        DoubleTap = 0x08,
+        Orientation = 0x10,
+        SleepChange = 0x20,
+
+        // EMB_FUNC_STATUS
+        StepDetected = 0x08 << 8,
+        Tilt = 0x10 << 8,
+        SignificantMotion = 0x20 << 8,
+        FsmLongCounter = 0x80 << 8,
+
+        // FSM_STATUS_A, FSM_STATUS_B
+        Fsm1 = 1 << 16, Fsm2 = 1 << 17, Fsm3 = 1 << 18, Fsm4 = 1 << 19,
+        Fsm5 = 1 << 20, Fsm6 = 1 << 21, Fsm7 = 1 << 22, Fsm8 = 1 << 23,
+        Fsm9 = 1 << 24, Fsm10 = 1 << 25, Fsm11 = 1 << 26, Fsm12 = 1 << 27,
+        Fsm13 = 1 << 28, Fsm14 = 1 << 29, Fsm15 = 1 << 30, Fsm16 = 1u << 31,
+
+        _BasicMask = 0x3F,
+        _EmbeddedMask = 0xB8 << 8,
+        _FsmMask = 0xFFFF0000,
+    };
+
+    DECLARE_FLAG_ENUM(Event);
+
+    //! Interrupt pin
+    enum struct IntPin
+    {
+        Int1,
+        Int2,
+    };
+
+    //! Functions of the embedded function bank, EMB_FUNC_EN_A and EMB_FUNC_EN_B
+    enum struct EmbeddedFunction : uint16_t
+    {
+        Pedometer = 0x08,
+        Tilt = 0x10,
+        SignificantMotion = 0x20,
+        Fsm = 0x01 << 8,
+        //! Machine learning core, available only on the LSM6DSOX, which reports the same WHO_AM_I
+        //! as the LSM6DSO, so the driver cannot detect whether it is present
+        Mlc = 0x10 << 8,
+    };
+
+    DECLARE_FLAG_ENUM(EmbeddedFunction);
+
+    //! Axes on which taps are detected
+    enum struct TapAxis : uint8_t
+    {
+        Z = 0x02,
+        Y = 0x04,
+        X = 0x08,
+        All = 0x0E,
+    };
+
+    DECLARE_FLAG_ENUM(TapAxis);
+
+    //! Free-fall threshold
+    enum struct FreeFallThreshold
+    {
+        Ths156mg,
+        Ths219mg,
+        Ths250mg,
+        Ths312mg,
+        Ths344mg,
+        Ths406mg,
+        Ths469mg,
+        Ths500mg,
+    };
+
+    //! Orientation (6D/4D) detection threshold
+    enum struct SixDThreshold
+    {
+        Deg80,
+        Deg70,
+        Deg60,
+        Deg50,
+    };
+
+    //! Power reduction applied while the device is inactive, see @ref ConfigureWakeUp
+    enum struct Inactivity
+    {
+        //! Inactivity is only reported as @ref Event::SleepChange
+        ReportOnly,
+        //! The accelerometer switches to 12.5 Hz, the gyroscope is not affected
+        AccelLowPower,
+        //! The accelerometer switches to 12.5 Hz, the gyroscope to sleep mode
+        GyroSleep,
+        //! The accelerometer switches to 12.5 Hz, the gyroscope is powered down
+        GyroPowerDown,
+    };
+
+    //! Sampling level, e.g. one of the levels selected by an @ref AdaptiveRate
+    struct RateLevel
+    {
+        //! Output data rate of the accelerometer and gyroscope, also used as their FIFO batching rates when the FIFO is enabled
+        Odr accel, gyro;
+        //! FIFO watermark in entries
+        uint16_t watermark;
+    };
+
+    //! Single line of a program generated by the vendor tools (.ucf file), loaded by @ref LoadProgram,
+    //! either a register write or a delay (the WAIT command)
+    struct UcfLine
+    {
+        enum struct Op : uint8_t
+        {
+            Write,
+            Delay,
+        };
+
+        uint8_t address;
+        //! Value written to @ref address, or the delay in milliseconds for @ref Op::Delay
+        uint8_t data;
+        Op op = Op::Write;
+
+        //! Creates a line corresponding to a WAIT command
+        static constexpr UcfLine Wait(uint8_t ms) { return { 0, ms, Op::Delay }; }
+    };
+
     //! Acceleration in X direction as a multiply of g (standard gravity)
     float GetAccelerationX() const { return ax; }
     //! Acceleration in Y direction as a multiply of g (standard gravity)
@@ -139,6 +295,14 @@ public:
     float GetAccelerationScale() const { return cfgDesired.GetAccelerationScale(); }
     //! Get full-scale range in dps (degrees per second)
     float GetAngularScale() const { return cfgDesired.GetAngularScale(); }
+    //! Temperature in degrees Celsius
+    float GetTemperature() const { return temp; }
+    //! Accelerometer offset as a multiply of g, subtracted from the output by the sensor, see @ref ConfigureAccelOffset
+    Vector3 GetAccelOffset() const
+    {
+        float mul = cfgDesired.accellUsrOffWeight ? 0x1p-6f : 0x1p-10f;
+        return { offsetDesired[0] * mul, offsetDesired[1] * mul, offsetDesired[2] * mul };
+    }
 
     //! Configures the output data rate
     void Configure(Odr accel, Odr gyro) { cfgDesired.accelOdr = accel; cfgDesired.gyroOdr = gyro; }
@@ -155,22 +319,111 @@ public:
         fifoDesired.tempOdr = temp;
         fifoDesired.tsRate = ts;
     }
+    //! Configures the FIFO watermark in entries
+    void ConfigureWatermark(uint16_t watermark) { fifoDesired.watermark = watermark; }
+    //! Switches to a different sampling level, the change is written by @ref ApplyConfiguration
+    //! as a minimal update of the affected registers, the FIFO contents are preserved
+    void Configure(const RateLevel& level)
+    {
+        Configure(level.accel, level.gyro);
+        if (fifoDesired.fifoMode != FifoMode::Bypass)
+        {
+            fifoDesired.accelOdr = level.accel;
+            fifoDesired.gyroOdr = level.gyro;
+        }
+        fifoDesired.watermark = level.watermark;
+    }
 
-    //! Initializes the sensor
-    async(Init);
-    //! Starts measuring
-    async(Start);
-    //! Stops measuring
-    async(Stop);
-    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
-    async(Measure);
-    //! Reads the next entry from fifo, return value indicates the type of value read
-    async(FifoRead);
+    //! Configures wake-up and activity/inactivity detection
+    //! @param threshold wake-up threshold in units of 1/64 of the accelerometer full-scale range (0-63)
+    //! @param duration number of samples the threshold must be exceeded (0-3)
+    //! @param sleepDuration duration of inactivity before @ref Event::SleepChange in units of 512 samples (0-15)
+    //! @param inactivity power reduction applied while inactive
+    void ConfigureWakeUp(uint8_t threshold, uint8_t duration = 0, uint8_t sleepDuration = 0, Inactivity inactivity = Inactivity::ReportOnly)
+    {
+        eventDesired.wakeThs = threshold;
+        eventDesired.wakeThsW = false;
+        eventDesired.wakeDur = duration;
+        eventDesired.sleepDur = sleepDuration;
+        eventDesired.inactivity = inactivity;
+        eventDesired.interruptsEnable = true;
+    }
+    //! Configures single and double tap detection
+    //! @param threshold tap threshold in units of 1/32 of the accelerometer full-scale range (1-31)
+    //! @param doubleTap enables double tap detection in addition to single tap
+    //! @param shock, quiet, duration tap timing windows as described in the datasheet (INT_DUR2), zero selects the default
+    void ConfigureTap(TapAxis axes, uint8_t threshold, bool doubleTap = false, uint8_t shock = 0, uint8_t quiet = 0, uint8_t duration = 0)
+    {
+        eventDesired.tapX = !!(axes & TapAxis::X);
+        eventDesired.tapY = !!(axes & TapAxis::Y);
+        eventDesired.tapZ = !!(axes & TapAxis::Z);
+        eventDesired.tapThsX = eventDesired.tapThsY = eventDesired.tapThsZ = threshold;
+        eventDesired.doubleTap = doubleTap;
+        eventDesired.tapShock = shock;
+        eventDesired.tapQuiet = quiet;
+        eventDesired.tapDur = duration;
+        eventDesired.interruptsEnable = true;
+    }
+    //! Configures free-fall detection
+    //! @param duration minimum duration of the free-fall in samples (0-63)
+    void ConfigureFreeFall(FreeFallThreshold threshold, uint8_t duration)
+    {
+        eventDesired.ffThs = threshold;
+        eventDesired.ffDur = duration & 0x1F;
+        eventDesired.ffDur5 = duration >> 5;
+        eventDesired.interruptsEnable = true;
+    }
+    //! Configures orientation detection, reported as @ref Event::Orientation
+    //! @param only4d ignores the Z axis, i.e. only portrait/landscape changes are reported
+    void ConfigureOrientation(SixDThreshold threshold, bool only4d = false)
+    {
+        eventDesired.sixdThs = threshold;
+        eventDesired.d4d = only4d;
+        eventDesired.interruptsEnable = true;
+    }
+    //! Configures the accelerometer offset (as a multiply of g) which the sensor subtracts from the output,
+    //! including FIFO data; the resolution is 2^-10 g (0.98 mg) up to 124 mg and 2^-6 g (15.6 mg) up to 1.98 g,
+    //! zero disables the correction
+    void ConfigureAccelOffset(float x, float y, float z);
+    //! Enables functions of the embedded function bank, replacing the currently enabled set
+    void EnableEmbedded(EmbeddedFunction functions) { embDesired.enable = functions; }
+    //! Routes events to an interrupt pin, replacing the events previously routed to it;
+    //! the pin is latched until the events are read by @ref ReadEvents, except for the
+    //! embedded and FSM events, which are pulsed unless the loaded program latches them
+    //! @param mlc mask of machine learning core decision trees routed to the pin
+    void RouteEvents(IntPin pin, Event events, uint8_t mlc = 0);
 
-protected:
-    const char* DebugComponent() const { return "LSM6DSO"; }
+    //! Gets the raw TAP_SRC value captured by the last @ref ReadEvents (tap axis and sign)
+    uint8_t GetTapSource() const { return eventSource[1]; }
+    //! Gets the raw D6D_SRC value captured by the last @ref ReadEvents (current orientation)
+    uint8_t GetOrientationSource() const { return eventSource[2]; }
+    //! Gets the raw WAKE_UP_SRC value captured by the last @ref ReadEvents (wake-up axis, sleep state)
+    uint8_t GetWakeUpSource() const { return eventSource[0]; }
 
-private:
+    //! Converts a sensor hub FIFO entry containing three little-endian 16-bit values
+    //! (e.g. LIS3MD output registers) using the specified multiplier
+    static Vector3 HubSampleValue(const FifoSample& smp, float mul)
+    {
+        return { int16_t(FROM_LE16(smp.x)) * mul, int16_t(FROM_LE16(smp.y)) * mul, int16_t(FROM_LE16(smp.z)) * mul };
+    }
+
+    //! Converts an accelerometer or gyroscope FIFO entry to g or dps respectively
+    Vector3 FifoSampleValue(const FifoSample& smp) const
+    {
+        float mul;
+        switch (smp.Tag())
+        {
+            case FifoTag::AccelNc: case FifoTag::AccelNcT1: case FifoTag::AccelNcT2: mul = amul; break;
+            case FifoTag::GyroNc: case FifoTag::GyroNcT1: case FifoTag::GyroNcT2: mul = gmul; break;
+            default: mul = 1; break;
+        }
+        return { int16_t(FROM_LE16(smp.x)) * mul, int16_t(FROM_LE16(smp.y)) * mul, int16_t(FROM_LE16(smp.z)) * mul };
+    }
+
+    //! Converts a temperature FIFO entry (@ref FifoTag::Temp) to degrees Celsius
+    static float TemperatureValue(const FifoSample& smp) { return TemperatureValue(smp.x); }
+
+protected:
     enum struct Register : uint8_t
     {
         FuncCfgAddress = 0x01,
@@ -213,7 +466,7 @@ private:
         EmbFuncStatus = 0x35,
         FsmStatusA = 0x36,
         FsmStatusB = 0x37,
-        StatusMaster = 0x29,
+        StatusMaster = 0x39,
 
         FifoStatus1 = 0x3A,
         FifoStatus2 = 0x3B,
@@ -257,6 +510,162 @@ private:
         Valid = 0x6C,
     };
 
+    //! Register bank selected through FUNC_CFG_ACCESS
+    enum struct FuncCfg : uint8_t
+    {
+        Main = 0,
+        SensorHub = 0x40,
+        Embedded = 0x80,
+    };
+
+    //! FUNC_CFG_ACCESS values referenced by register write sequences
+    static constexpr FuncCfg MainBank = FuncCfg::Main, SensorHubBank = FuncCfg::SensorHub, EmbeddedBank = FuncCfg::Embedded;
+
+    //! Registers of the sensor hub bank
+    enum struct HubRegister : uint8_t
+    {
+        SensorHub1 = 0x02,
+        MasterConfig = 0x14,
+        Slv0Add = 0x15,
+        Slv0Subadd = 0x16,
+        Slv0Config = 0x17,
+        DataWriteSlv0 = 0x21,
+        StatusMaster = 0x22,
+    };
+
+    //! MASTER_CONFIG bits
+    enum struct MasterConfig : uint8_t
+    {
+        AuxSensOnMask = 0x03,
+        MasterOn = 0x04,
+        PullUpEnable = 0x08,
+        PassThrough = 0x10,
+        StartConfig = 0x20,
+        WriteOnce = 0x40,
+        ResetMasterRegs = 0x80,
+    };
+
+    //! STATUS_MASTER bits
+    enum struct HubStatus : uint8_t
+    {
+        EndOp = 0x01,
+        Slave0Nack = 0x08,
+        Slave1Nack = 0x10,
+        Slave2Nack = 0x20,
+        Slave3Nack = 0x40,
+        WriteOnceDone = 0x80,
+    };
+
+    DECLARE_FLAG_ENUM(MasterConfig);
+    DECLARE_FLAG_ENUM(HubStatus);
+
+    //! Registers of the embedded function bank
+    enum struct EmbRegister : uint8_t
+    {
+        PageSel = 0x02,
+        EmbFuncEnA = 0x04,
+        EmbFuncEnB = 0x05,
+        PageAddress = 0x08,
+        PageValue = 0x09,
+        EmbFuncInt1 = 0x0A,
+        FsmInt1A = 0x0B,
+        FsmInt1B = 0x0C,
+        //! MLC_INT1, MLC_INT2, MLC_STATUS and MLC0_SRC - MLC7_SRC exist only on the LSM6DSOX
+        MlcInt1 = 0x0D,
+        EmbFuncInt2 = 0x0E,
+        FsmInt2A = 0x0F,
+        FsmInt2B = 0x10,
+        MlcInt2 = 0x11,
+        EmbFuncStatus = 0x12,
+        FsmStatusA = 0x13,
+        FsmStatusB = 0x14,
+        MlcStatus = 0x15,
+        PageRw = 0x17,
+        FsmEnableA = 0x46,
+        FsmEnableB = 0x47,
+        StepCounterL = 0x62,
+        StepCounterH = 0x63,
+        EmbFuncSrc = 0x64,
+        EmbFuncInitA = 0x66,
+        EmbFuncInitB = 0x67,
+        Mlc0Src = 0x70,
+    };
+
+    //! EMB_FUNC_SRC bits
+    enum
+    {
+        PedoRstStep = 0x80,
+    };
+
+    enum
+    {
+        //! Number of external sensors the sensor hub can poll
+        HubSlaves = 4,
+        //! Size of the SENSOR_HUB_x output register block
+        HubOutputSize = 18,
+        //! Number of STATUS_MASTER polls while waiting for a sensor hub write
+        HubWriteAttempts = 20,
+        //! Delay between STATUS_MASTER polls in milliseconds
+        HubWritePollMs = 10,
+    };
+
+    //! Sensor hub slave configuration, SLVx_ADD, SLVx_SUBADD, SLVx_CONFIG
+    struct HubSlaveConfig
+    {
+        uint8_t add;
+        uint8_t subadd;
+        uint8_t config;
+    };
+
+    //! Sensor hub register bank, selected by writing @ref FuncCfg::SensorHub to FUNC_CFG_ACCESS
+    static constexpr RegisterMap HubMap = RegisterMap(0, {
+        { HubRegister::SensorHub1, RegisterAccess::Read, 0, HubOutputSize },
+        { HubRegister::MasterConfig, RegisterAccess::ReadWrite, 0, 13 },   // MASTER_CONFIG - SLV3_CONFIG
+        { HubRegister::DataWriteSlv0, RegisterAccess::ReadWrite },
+        { HubRegister::StatusMaster, RegisterAccess::Read },
+    });
+
+    //! Embedded function register bank, selected by writing @ref FuncCfg::Embedded to FUNC_CFG_ACCESS
+    static constexpr RegisterMap EmbMap = RegisterMap(0, {
+        { EmbRegister::PageSel, RegisterAccess::ReadWrite, 0x01 },
+        { EmbRegister::EmbFuncEnA, RegisterAccess::ReadWrite, 0, 2 },
+        { EmbRegister::PageAddress, RegisterAccess::ReadWrite, 0, 2 },
+        { EmbRegister::EmbFuncInt1, RegisterAccess::ReadWrite, 0, 8 },     // EMB_FUNC_INT1 - MLC_INT2
+        { EmbRegister::EmbFuncStatus, RegisterAccess::Read, 0, 4 },
+        { EmbRegister::PageRw, RegisterAccess::ReadWrite },
+        { EmbRegister::FsmEnableA, RegisterAccess::ReadWrite, 0, 2 },
+        { EmbRegister::StepCounterL, RegisterAccess::Read, 0, 2 },
+        { EmbRegister::EmbFuncSrc, RegisterAccess::ReadWrite },
+        { EmbRegister::EmbFuncInitA, RegisterAccess::ReadWrite, 0, 2 },
+        { EmbRegister::Mlc0Src, RegisterAccess::Read, 0, 8 },
+    });
+
+    //! Main register page, with IF_INC (default) the address increments automatically in bursts
+    static constexpr RegisterMap Map = RegisterMap(0, {
+        { Register::FuncCfgAddress, RegisterAccess::ReadWrite },
+        { Register::PinCtrl, RegisterAccess::ReadWrite, 0x3F },
+        { Register::FifoCtrl1, RegisterAccess::ReadWrite, 0, 8 },         // FIFO_CTRL1-4, COUNTER_BDR_REG1-2, INT1/2_CTRL
+        { Register::ID, RegisterAccess::Read, uint8_t(IDValue::Valid) },
+        { Register::Control1, RegisterAccess::ReadWrite, 0, 2 },
+        { Register::Control3, RegisterAccess::ReadWrite, 0x04 },
+        { Register::Control4, RegisterAccess::ReadWrite, 0, 5 },
+        { Register::Control9, RegisterAccess::ReadWrite, 0xE0 },
+        { Register::Control10, RegisterAccess::ReadWrite },
+        { Register::AllIntSrc, RegisterAccess::Read, 0, 5 },               // ALL_INT_SRC - STATUS_REG
+        { 0x1F, RegisterAccess::Read },                                     // reserved, read as part of the output burst
+        { Register::OutTempL, RegisterAccess::Read, 0, 14 },
+        { Register::EmbFuncStatus, RegisterAccess::Read, 0, 3 },
+        { 0x39, RegisterAccess::Read },                                     // STATUS_MASTER_MAINPAGE
+        { Register::FifoStatus1, RegisterAccess::Read, 0, 2 },
+        { Register::Timestamp0, RegisterAccess::Read, 0, 4 },
+        { Register::TapCfg0, RegisterAccess::ReadWrite, 0, 10 },           // TAP_CFG0 - MD2_CFG
+        { Register::I3CBusAvb, RegisterAccess::ReadWrite },
+        { Register::IntFreqFine, RegisterAccess::Read },
+        { Register::OisInt, RegisterAccess::Read, 0, 4 },                  // writable only from the auxiliary SPI
+        { Register::XOfsUsr, RegisterAccess::ReadWrite, 0, 3 },
+        { Register::FifoOutTag, RegisterAccess::Read, 0, 7 },
+    });
+
     enum struct Status : uint8_t
     {
         ReadyAccel = 1,
@@ -304,7 +713,15 @@ private:
         NoCompress32,
     };
 
-    async(UpdateConfiguration);
+    //! Output block read by @ref Measure, STATUS_REG to OUTZ_H_A
+    PACKED_UNALIGNED_STRUCT MeasureData
+    {
+        Status status;
+        uint8_t resvd;
+        int16_t temp;
+        int16_t gx, gy, gz;
+        int16_t ax, ay, az;
+    };
 
     struct FifoConfig
     {
@@ -409,13 +826,265 @@ private:
         float GetAngularScale() const { return 125 << ((int(gyroFs) & 1) ? 0 : (int(gyroFs) >> 1)); }
     } cfgActual, cfgDesired = { .ifInc = 1 };
 
-    bool init = false;
-    uint8_t lastFifoTag = 0;
+    struct EventConfig
+    {
+        // TAP_CFG0, default 00
+        bool latch : 1;
+        bool tapZ : 1;
+        bool tapY : 1;
+        bool tapX : 1;
+        bool slopeFds : 1;
+        bool sleepStatusOnInt : 1;
+        bool clearOnRead : 1;
+        uint8_t : 1;
+
+        // TAP_CFG1, default 00
+        uint8_t tapThsX : 5;
+        uint8_t tapPriority : 3;
+
+        // TAP_CFG2, default 00
+        uint8_t tapThsY : 5;
+        Inactivity inactivity : 2;
+        bool interruptsEnable : 1;
+
+        // TAP_THS_6D, default 00
+        uint8_t tapThsZ : 5;
+        SixDThreshold sixdThs : 2;
+        bool d4d : 1;
+
+        // INT_DUR2, default 00
+        uint8_t tapShock : 2;
+        uint8_t tapQuiet : 2;
+        uint8_t tapDur : 4;
+
+        // WAKE_UP_THS, default 00
+        uint8_t wakeThs : 6;
+        bool usrOffOnWu : 1;
+        bool doubleTap : 1;
+
+        // WAKE_UP_DUR, default 00
+        uint8_t sleepDur : 4;
+        bool wakeThsW : 1;
+        uint8_t wakeDur : 2;
+        bool ffDur5 : 1;
+
+        // FREE_FALL, default 00
+        FreeFallThreshold ffThs : 3;
+        uint8_t ffDur : 5;
+
+        // MD1_CFG, MD2_CFG, default 00
+        uint8_t md[2];
+    } eventActual, eventDesired = {};
+
+    struct EmbeddedConfig
+    {
+        // EMB_FUNC_EN_A, EMB_FUNC_EN_B
+        EmbeddedFunction enable;
+
+        // EMB_FUNC_INTx, FSM_INTx_A, FSM_INTx_B, MLC_INTx
+        struct
+        {
+            uint8_t emb;
+            uint8_t fsmA;
+            uint8_t fsmB;
+            uint8_t mlc;
+        } route[2];
+    } embActual, embDesired = {};
+
+    struct HubConfig
+    {
+        // MASTER_CONFIG, default 00
+        MasterConfig master;
+        // SLV0_ADD - SLV3_CONFIG, default 00
+        HubSlaveConfig slv[HubSlaves];
+    } hubActual, hubDesired = {};
+
+    //! X_OFS_USR - Z_OFS_USR
+    int8_t offsetActual[3] = {}, offsetDesired[3] = {};
+
+    //! WAKE_UP_SRC, TAP_SRC and D6D_SRC captured by the last @ref ReadEvents
+    uint8_t eventSource[3] = {};
     float ax = NAN, ay = NAN, az = NAN;
     float gx = NAN, gy = NAN, gz = NAN;
+    float temp = NAN;
     float amul, gmul;
+
+    //! Gets the number of bytes read by sensor hub slave @p slot, zero if the slave is not being polled
+    uint8_t HubLength(unsigned slot) const
+    {
+        return !!(hubActual.master & MasterConfig::MasterOn) && slot <= unsigned(hubActual.master & MasterConfig::AuxSensOnMask) ?
+            hubActual.slv[slot].config & 7 : 0;
+    }
+
+    //! Converts the raw OUT_TEMP value, 256 LSB/degC with zero at 25 degC
+    static float TemperatureValue(int16_t raw) { return 25 + int16_t(FROM_LE16(raw)) * (1.0f / 256); }
+};
+
+DEFINE_FLAG_ENUM(LSM6DSOBase::Status);
+DEFINE_FLAG_ENUM(LSM6DSOBase::MasterConfig);
+DEFINE_FLAG_ENUM(LSM6DSOBase::HubStatus);
+DEFINE_FLAG_ENUM(LSM6DSOBase::Event);
+DEFINE_FLAG_ENUM(LSM6DSOBase::EmbeddedFunction);
+DEFINE_FLAG_ENUM(LSM6DSOBase::TapAxis);
+
+//! Driver for the LSM6DSO, the @p TSensor base selects the transport,
+//! see @ref StaticSensor for alternatives to the runtime-selected @ref Sensor
+template<class TSensor = Sensor> class LSM6DSOT : public LSM6DSOBase, TSensor
+{
+    using TSensor::ReadRegister;
+    using TSensor::WriteRegister;
+    using TSensor::UpdateRegisters;
+    using TSensor::ReadSequence;
+    using TSensor::WriteSequence;
+    using TSensor::RegisterFrameSize;
+    using TSensor::MYDBG;
+    using TSensor::MYTRACE;
+#if SENSOR_STATS
+    using TSensor::Stats;
+#endif
+
+public:
+    LSM6DSOT(bus::I2C i2c, Address address)
+        : TSensor(i2c, (uint8_t)address)
+    {
+    }
+
+    LSM6DSOT(bus::SPI spi, GPIOPin cs)
+        : TSensor(spi, cs, 0x80, 0x00)
+    {
+    }
+
+#if !SENSORS_NO_I2C && !SENSORS_NO_SPI
+    //! Creates the driver on top of an externally owned interface, e.g. a @ref ReplayInterface,
+    //! available only with the runtime-selected @ref Sensor
+    template<class T = TSensor> LSM6DSOT(Interface& interface)
+        : T(interface)
+    {
+    }
+#endif
+
+    //! Initializes the sensor
+    async(Init);
+    //! Starts measuring
+    async(Start);
+    //! Stops measuring
+    async(Stop);
+    //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
+    async(Measure);
+    //! Reads the next entry from fifo, return value indicates the type of value read
+    async(FifoRead);
+    //! Reads up to @p count entries from fifo in a single burst, returns the number of entries read
+    //! If the burst fails, the batch is counted as dropped and not repeated, as the entries have been popped already
+    async(ReadFifo, FifoSample* buffer, size_t count);
+    //! Reads up to @p n entries from fifo in a single burst, returns the number of entries read
+    template<size_t n> async(ReadFifo, FifoSample (&buffer)[n]) { return async_forward(ReadFifo, buffer, n); }
+    //! Writes a register of an external sensor on the auxiliary bus, used to configure it before
+    //! calling @ref ConfigureHub; the write is performed by the sensor hub on the next accelerometer
+    //! sample, so the accelerometer must be running
+    async(HubWrite, uint8_t address, uint8_t reg, uint8_t value);
+    //! Configures the sensor hub to poll up to four external sensors on every accelerometer sample,
+    //! the data of slave N is batched in the FIFO under tag @ref FifoTag::Slave0 + N;
+    //! the configuration is restored after the device is recovered or reinitialized
+    async(ConfigureHub, const HubSlave* slaves, size_t count, HubOdr odr = HubOdr::Odr104Hz);
+    //! Configures the sensor hub to poll up to four external sensors, see @ref ConfigureHub
+    template<size_t n> async(ConfigureHub, const HubSlave (&slaves)[n], HubOdr odr = HubOdr::Odr104Hz) { return async_forward(ConfigureHub, slaves, n, odr); }
+    //! Stops polling external sensors
+    async(DisableHub);
+    //! Reads the latest data of sensor hub slave @p slot from the sensor hub output registers
+    async(ReadHub, unsigned slot, Buffer buf);
+    //! Applies configuration changes made after @ref Init, e.g. to switch between wake-up detection and streaming
+    async(ApplyConfiguration);
+    //! Reads and clears the pending events, returns a combination of @ref Event flags,
+    //! the details of the last tap and orientation change are available through
+    //! @ref GetTapSource and @ref GetOrientationSource
+    async(ReadEvents);
+    //! Sleeps until an event is signalled on @p pin, which must be connected to the interrupt pin
+    //! to which the events are routed, and reads the events, see @ref ReadEvents
+    async(WaitForEvents, GPIOPin pin);
+    //! Reads the number of steps counted by the pedometer
+    async(ReadStepCount, uint16_t& steps);
+    //! Resets the pedometer step counter
+    async(ResetStepCount);
+    //! Reads the outputs of the eight machine learning core decision trees, MLC0_SRC - MLC7_SRC,
+    //! requires the LSM6DSOX, on the LSM6DSO the registers are reserved and the results are meaningless
+    async(ReadMlcResults, uint8_t (&results)[8]);
+    //! Loads a finite state machine or machine learning core program generated by the vendor tools,
+    //! the program is executed as-is, the register shadows are synchronized with the device afterwards;
+    //! programs are lost when the device is reinitialized and must be loaded again;
+    //! machine learning core programs require the LSM6DSOX, see @ref EmbeddedFunction::Mlc
+    async(LoadProgram, const UcfLine* program, size_t count);
+    //! Loads a program generated by the vendor tools, see @ref LoadProgram
+    template<size_t n> async(LoadProgram, const UcfLine (&program)[n]) { return async_forward(LoadProgram, program, n); }
+
+#if SENSOR_STATS
+    //! Gets the bus transfer and measurement statistics
+    using TSensor::Statistics;
+#endif
+#if SENSOR_RECORD && !SENSORS_NO_I2C && !SENSORS_NO_SPI
+    //! Logs register transactions, see @ref BusRecorder, available only with the runtime-selected @ref Sensor
+    template<class T = TSensor> void Record(BusRecorder* recorder, uint8_t device) { T::Record(recorder, device); }
+#endif
+
+protected:
+    const char* DebugComponent() const { return "LSM6DSO"; }
+
+private:
+    async(UpdateConfiguration);
+    //! Writes the embedded function configuration, switching back to the main bank afterwards
+    async(UpdateEmbedded);
+    //! Writes the sensor hub master and slave configuration, switching back to the main bank afterwards
+    async(UpdateHub);
+    //! Writes registers of the sensor hub or embedded function bank, switching back to the main bank afterwards
+    async(WriteBankRegisters, const FuncCfg& bank, uint8_t reg, Span data);
+    //! Reads registers of the sensor hub or embedded function bank, switching back to the main bank afterwards
+    async(ReadBankRegisters, const FuncCfg& bank, uint8_t reg, Buffer buf);
+    //! Reads registers, climbing the recovery ladder if the transaction fails
+    async(ReadRegisterRecover, Register reg, Buffer buf);
+    //! Verifies the device state after repeated failures, restoring the configuration
+    //! without a reset if possible, forces a full reinitialization only as a last resort
+    async(Recover);
+    //! Counts FIFO entries lost to a failed recovery, @p popped already removed and the ones still queued,
+    //! which are flushed by the reinitialization that follows
+    async(CountFifoLoss, size_t popped);
+
+    bool init = false;
+    uint8_t lastFifoTag = 0;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry UpdateEmbedded = { FrameSize<RegisterWrite[4]>, RegisterFrameSize };
+        static constexpr FrameEntry UpdateHub = { FrameSize<RegisterWrite[4]>, RegisterFrameSize };
+        static constexpr FrameEntry UpdateConfiguration = { FrameSize<>, FrameMax(RegisterFrameSize, UpdateEmbedded, UpdateHub) };
+        static constexpr FrameEntry Init = { FrameSize<IDValue, uint8_t>, FrameMax(RegisterFrameSize, UpdateConfiguration) };
+        static constexpr FrameEntry Recover = { FrameSize<IDValue, Config, FifoConfig, EventConfig, int8_t[3]>, FrameMax(RegisterFrameSize, UpdateConfiguration) };
+        static constexpr FrameEntry ReadRegisterRecover = { FrameSize<>, FrameMax(RegisterFrameSize, Recover) };
+        static constexpr FrameEntry Measure = { FrameSize<MeasureData, FrameStatsStart>, FrameMax(Init, ReadRegisterRecover) };
+        static constexpr FrameEntry CountFifoLoss = { FrameSize<size_t, uint16_t>, RegisterFrameSize };
+        static constexpr FrameEntry FifoRead = { FrameSize<FifoSample>, FrameMax(Init, RegisterFrameSize, Recover, CountFifoLoss) };
+        static constexpr FrameEntry ReadFifo = { FrameSize<uint16_t, size_t>, FrameMax(Init, RegisterFrameSize, Recover, CountFifoLoss) };
+        static constexpr FrameEntry WriteBankRegisters = { FrameSize<RegisterWrite[3]>, RegisterFrameSize };
+        static constexpr FrameEntry ReadBankRegisters = { FrameSize<bool>, RegisterFrameSize };
+        static constexpr FrameEntry HubWrite = { FrameSize<HubSlaveConfig, uint8_t, MasterConfig, HubStatus, RegisterWrite[5], int>, FrameMax(Init, WriteBankRegisters) };
+        static constexpr FrameEntry ConfigureHub = { FrameSize<>, FrameMax(Init, UpdateHub) };
+        static constexpr FrameEntry DisableHub = { FrameSize<>, UpdateHub };
+        static constexpr FrameEntry ReadHub = { FrameSize<>, ReadBankRegisters };
+        static constexpr FrameEntry ReadEvents = { FrameSize<uint8_t[5], uint8_t[3], RegisterRead[2]>, FrameMax(Init, RegisterFrameSize) };
+        static constexpr FrameEntry WaitForEvents = { FrameSize<>, FrameMax(SENSOR_FRAME_BUS, ReadEvents) };    // GPIOPin::WaitFor
+        static constexpr FrameEntry ApplyConfiguration = { FrameSize<>, FrameMax(Init, UpdateConfiguration) };
+        static constexpr FrameEntry ReadStepCount = { FrameSize<>, FrameMax(Init, ReadBankRegisters) };
+        static constexpr FrameEntry ReadMlcResults = { FrameSize<>, FrameMax(Init, ReadBankRegisters) };
+        static constexpr FrameEntry ResetStepCount = { FrameSize<uint8_t>, FrameMax(Init, WriteBankRegisters) };
+        static constexpr FrameEntry LoadProgram = { FrameSize<size_t, RegisterRead[4]>, FrameMax(Init, RegisterFrameSize, ReadBankRegisters, UpdateConfiguration) };
+    };
 };
 
-DEFINE_FLAG_ENUM(LSM6DSO::Status);
+//! LSM6DSO driver with the transport selected at runtime
+class LSM6DSO : public LSM6DSOT<>
+{
+public:
+    using LSM6DSOT::LSM6DSOT;
+};
 
 }
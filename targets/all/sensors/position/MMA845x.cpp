@@ -14,6 +14,7 @@ namespace sensors::position
 async(MMA845x::Init)
 async_def(Control2 ctl2)
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     MYDBG("Reading ID...");
     if (!await(ReadRegister, Register::ID, id))
     {
@@ -53,17 +54,28 @@ async_def(Control2 ctl2)
     } while (!!(f.ctl2 & Control2::Reset));
 
     if (!await(ReadRegister, Register::DataConfig, cfgActual.dcfg) ||
-        !await(ReadRegister, Register::Control1, cfgActual.ctl))
+        !await(ReadRegister, Register::AslpCount, cfgActual.ctl))
     {
         async_return(false);
     }
 
+    // the remaining registers are in their reset state
+    cfgActual.fsetup = 0;
+    detActual = DetectionRegisters();
+
+    if (cfgDesired.fsetup && id != IDValue::MMA8451)
+    {
+        MYDBG("FIFO is available only on MMA8451");
+        cfgDesired.fsetup = 0;
+    }
+
     if (!await(UpdateConfiguration))
     {
         async_return(false);
     }
 
     MYDBG("Init complete");
+    SENSOR_STATS_COUNT(inits);
     async_return(init = true);
 }
 async_end
@@ -71,6 +83,7 @@ async_end
 async(MMA845x::Configure, Config cfg)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Configure);
     cfgDesired.ctl.reg1 = (Control1)cfg;
     cfgDesired.ctl.reg2 = (Control2)((uint32_t)cfg >> 8);
     cfgDesired.dcfg = (DataConfig)((uint32_t)cfg >> 16);
@@ -87,7 +100,8 @@ async_end
 async(MMA845x::UpdateConfiguration)
 async_def(bool wasActive)
 {
-    if (cfgActual.CompareValue() != cfgDesired.CompareValue())
+    SENSOR_FRAME_FIELDS(FrameSizes::UpdateConfiguration);
+    if (cfgActual.CompareValue() != cfgDesired.CompareValue() || Span(detActual) != Span(detDesired))
     {
         f.wasActive = IsActive();
         if (f.wasActive && !await(Stop))
@@ -95,16 +109,17 @@ async_def(bool wasActive)
             async_return(false);
         }
 
-        if (!await(WriteRegister, Register::DataConfig, cfgDesired.dcfg) ||
-            !await(WriteRegister, Register::Control1, cfgDesired.ctl))
+        // all registers are writable only in standby mode
+        if (!await(UpdateRegisters, Register::DataConfig, cfgActual.dcfg, cfgDesired.dcfg) ||
+            !await(UpdateRegisters, Register::FifoSetup, cfgActual.fsetup, cfgDesired.fsetup) ||
+            !await(UpdateRegisters, Register::PlConfig, detActual, detDesired, DetectionVolatile) ||
+            !await(UpdateRegisters, Register::AslpCount, cfgActual.ctl, cfgDesired.ctl))
         {
             // need re-init
             init = false;
             async_return(false);
         }
 
-        cfgActual = cfgDesired;
-
         if (f.wasActive && !await(Start))
         {
             async_return(false);
@@ -117,9 +132,91 @@ async_def(bool wasActive)
 }
 async_end
 
+async(MMA845x::ReadRegisterRecover, Register reg, Buffer buf)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadRegisterRecover);
+    if (await(ReadRegister, reg, buf))
+    {
+        async_return(true);
+    }
+
+    // a single glitch on the bus, repeat the transaction
+    if (await(ReadRegister, reg, buf))
+    {
+        SENSOR_STATS_COUNT(retries);
+        async_return(true);
+    }
+
+    async_return(await(Recover) && await(ReadRegister, reg, buf));
+}
+async_end
+
+async(MMA845x::Recover)
+async_def(
+    IDValue id;
+    ConfigRegisters cfg;
+    bool active;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::Recover);
+    f.cfg.fsetup = cfgActual.fsetup;
+    if (await(ReadRegister, Register::ID, f.id) && f.id == id &&
+        await(ReadRegister, Register::DataConfig, f.cfg.dcfg) &&
+        (id != IDValue::MMA8451 || await(ReadRegister, Register::FifoSetup, f.cfg.fsetup)) &&
+        await(ReadRegister, Register::AslpCount, f.cfg.ctl))
+    {
+        if (f.cfg.CompareValue() == cfgActual.CompareValue() && f.cfg.IsActive() == cfgActual.IsActive())
+        {
+            MYDBG("Recovered, configuration intact");
+            SENSOR_STATS_COUNT(verified);
+            async_return(true);
+        }
+
+        // the configuration has been lost, write it again without resetting
+        MYDBG("Restoring configuration, DCFG = %02X, CTL1 = %02X, CTL2 = %02X", f.cfg.dcfg, f.cfg.ctl.reg1, f.cfg.ctl.reg2);
+        f.active = cfgActual.IsActive();
+        cfgActual = f.cfg;
+        // the detection registers are assumed to have been reset as well
+        detActual = DetectionRegisters();
+        if (await(UpdateConfiguration) && (f.active ? await(Start) : await(Stop)))
+        {
+            SENSOR_STATS_COUNT(restored);
+            async_return(true);
+        }
+    }
+
+    MYDBG("Recovery failed, reinitializing");
+    SENSOR_STATS_COUNT(resets);
+    init = false;
+    async_return(false);
+}
+async_end
+
+async(MMA845x::CountFifoLoss, size_t popped)
+async_def(
+    size_t popped;
+    uint8_t status;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::CountFifoLoss);
+#if SENSOR_STATS
+    f.popped = popped;
+    // the level may still be readable if only the configuration was lost
+    if (await(ReadRegister, Register::Status, f.status))
+    {
+        f.popped += f.status & FifoCountMask;
+    }
+    SENSOR_STATS_ADD(dropped, f.popped);
+#endif
+    async_return(true);
+}
+async_end
+
 async(MMA845x::Start)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Start);
     if (!init && !await(Init))
     {
         async_return(false);
@@ -144,6 +241,7 @@ async_end
 async(MMA845x::Stop)
 async_def()
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Stop);
     if (init && IsActive())
     {
         cfgActual.ctl.reg1 = cfgActual.ctl.reg1 & ~Control1::Active;
@@ -162,20 +260,37 @@ async_end
 
 async(MMA845x::Measure)
 async_def(
-    PACKED_UNALIGNED_STRUCT
+    union
     {
-        Status status;
-        int16_t x, y, z;
-    } data;
+        PACKED_UNALIGNED_STRUCT
+        {
+            Status status;
+            int16_t x, y, z;
+        } data;
+        PACKED_UNALIGNED_STRUCT
+        {
+            Status status;
+            int8_t x, y, z;
+        } fast;
+    };
+#if SENSOR_STATS
+    mono_t start;
+#endif
 )
 {
-    if (!IsActive() && !await(Start))
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
+#if SENSOR_STATS
+    f.start = MONO_CLOCKS;
+#endif
+    if ((!init || !IsActive()) && !await(Start))
     {
-        // start measuring if not started
+        // (re)initialize and start measuring if not started
         async_return(false);
     }
 
-    if (!await(ReadRegister, Register::Status, f.data) || (f.data.status & Status::ReadyAll) != Status::ReadyAll)
+    // in fast-read mode, the LSB registers are skipped
+    if (!await(ReadRegisterRecover, Register::Status, Buffer(&f.data, cfgActual.IsFastRead() ? sizeof(f.fast) : sizeof(f.data))) ||
+        !DataReady(f.data.status))
     {
         MYDBG("no data available, status: %02X, ctl1: %02X", f.data.status, cfgActual.ctl.reg1);
         async_return(false);
@@ -186,12 +301,165 @@ async_def(
         MYDBG("overrun, status: %02X", f.data.status);
     }
 
-    x = int16_t(FROM_BE16(f.data.x)) * mul;
-    y = int16_t(FROM_BE16(f.data.y)) * mul;
-    z = int16_t(FROM_BE16(f.data.z)) * mul;
+    if (cfgActual.IsFastRead())
+    {
+        x = f.fast.x * mul * 256;
+        y = f.fast.y * mul * 256;
+        z = f.fast.z * mul * 256;
+    }
+    else
+    {
+        x = int16_t(FROM_BE16(f.data.x)) * mul;
+        y = int16_t(FROM_BE16(f.data.y)) * mul;
+        z = int16_t(FROM_BE16(f.data.z)) * mul;
+    }
     MYDBG("new data: X=%.3q Y=%.3q Z=%.3q", int(x * 1000), int(y * 1000), int(z * 1000));
+    SENSOR_STATS_MEASURE(f.start);
     async_return(true);
 }
 async_end
 
+async(MMA845x::ApplyConfiguration)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ApplyConfiguration);
+    if (!init)
+    {
+        async_return(await(Init));
+    }
+
+    async_return(await(UpdateConfiguration));
+}
+async_end
+
+async(MMA845x::ReadFifoImpl, void* buffer, size_t count, size_t size)
+async_def(
+    uint8_t status;
+    size_t count;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadFifoImpl);
+    if ((!init || !IsActive()) && !await(Start))
+    {
+        async_return(0);
+    }
+
+    if (!cfgActual.IsFifo())
+    {
+        MYDBG("FIFO is not enabled");
+        async_return(0);
+    }
+
+    ASSERT(size == (cfgActual.IsFastRead() ? sizeof(FastFifoSample) : sizeof(FifoSample)));
+
+    if (count == 0)
+    {
+        async_return(0);
+    }
+
+    if (!await(ReadRegister, Register::Status, f.status))
+    {
+        // nothing has been popped yet, the FIFO is drained on the next call
+        if (!await(Recover))
+        {
+            await(CountFifoLoss, 0);
+        }
+        async_return(0);
+    }
+
+    if (f.status & FifoOverflow)
+    {
+        SENSOR_STATS_COUNT(overruns);
+    }
+
+    f.count = std::min(count, size_t(f.status & FifoCountMask));
+    if (!f.count)
+    {
+        async_return(0);
+    }
+
+    // the address rolls back to OUT_X_MSB after each sample, so the whole batch can be read in one burst
+    if (!await(ReadRegister, Register::OutXH, Buffer(buffer, f.count * size)))
+    {
+        // an unknown part of the batch has been popped, repeating the burst would return different data;
+        // the batch is lost, but the FIFO keeps running if the configuration survived
+        if (await(Recover))
+        {
+            SENSOR_STATS_ADD(dropped, f.count);
+        }
+        else
+        {
+            await(CountFifoLoss, f.count);
+        }
+        async_return(0);
+    }
+
+    async_return(f.count);
+}
+async_end
+
+async(MMA845x::ReadEvents)
+async_def(
+    PACKED_UNALIGNED_STRUCT
+    {
+        uint8_t sysmod;
+        Event source;
+    } regs;
+)
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::ReadEvents);
+    if (!init && !await(Init))
+    {
+        async_return(0);
+    }
+
+    // SYSMOD and INT_SOURCE, reading SYSMOD clears the sleep/wake event
+    if (!await(ReadRegister, Register::SysMode, f.regs))
+    {
+        async_return(0);
+    }
+
+    // the remaining latched events are cleared by reading their source registers
+    if (!!(f.regs.source & Event::Motion) && !await(ReadRegister, Register::FfMtSource, motionSource))
+    {
+        async_return(0);
+    }
+    if (!!(f.regs.source & Event::Transient) && !await(ReadRegister, Register::TransientSource, transientSource))
+    {
+        async_return(0);
+    }
+    if (!!(f.regs.source & Event::Orientation) && !await(ReadRegister, Register::PlStatus, orientationSource))
+    {
+        async_return(0);
+    }
+
+    MYTRACE("events: %02X, sysmod: %02X", f.regs.source, f.regs.sysmod);
+    async_return(intptr_t(f.regs.source));
+}
+async_end
+
+async(MMA845x::WaitForEvents, GPIOPin pin)
+async_def()
+{
+    SENSOR_FRAME_FIELDS(FrameSizes::WaitForEvents);
+    // the MCU sleeps until the pin becomes active, the polarity is selected by IPOL in CTRL_REG3
+    await(pin.WaitFor, !!(cfgActual.ctl.reg3 & Control3::ActiveHigh));
+    async_return(await(ReadEvents));
+}
+async_end
+
+#ifndef SENSOR_FRAME_BUDGET_MMA845x
+#define SENSOR_FRAME_BUDGET_MMA845x    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(MMA845x, Init, MMA845x::FrameSizes::Init);
+SENSOR_FRAME_CHECK(MMA845x, Configure, MMA845x::FrameSizes::Configure);
+SENSOR_FRAME_CHECK(MMA845x, Start, MMA845x::FrameSizes::Start);
+SENSOR_FRAME_CHECK(MMA845x, Stop, MMA845x::FrameSizes::Stop);
+SENSOR_FRAME_CHECK(MMA845x, Measure, MMA845x::FrameSizes::Measure);
+SENSOR_FRAME_CHECK(MMA845x, ApplyConfiguration, MMA845x::FrameSizes::ApplyConfiguration);
+SENSOR_FRAME_CHECK(MMA845x, ReadFifoImpl, MMA845x::FrameSizes::ReadFifoImpl);
+SENSOR_FRAME_CHECK(MMA845x, ReadEvents, MMA845x::FrameSizes::ReadEvents);
+SENSOR_FRAME_CHECK(MMA845x, WaitForEvents, MMA845x::FrameSizes::WaitForEvents);
+
 }
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <sensors/I2CSensor.h>
+#include <math/Vector3.h>
 
 namespace sensors::position
 {
@@ -27,6 +28,8 @@ public:
     enum struct Config : uint32_t
     {
         // values for CTRL_REG1
+        //! Only the most significant byte of each axis is read (3 bytes per sample instead of 6)
+        FastRead = 2,
         LowNoise = 4,
 
         Rate800Hz = 0 << 3,
@@ -41,16 +44,102 @@ public:
         RateFastest = Rate800Hz,
         RateSlowest = Rate1p56Hz,
 
+        //! Output data rate while auto-sleeping, see @ref AutoSleep
+        SleepRate50Hz = 0 << 6,
+        SleepRate12p5Hz = 1 << 6,
+        SleepRate6p25Hz = 2 << 6,
+        SleepRate1p56Hz = 3 << 6,
+
         // values for CTRL_REG2
         ModeNormal = 0 << 8,
         ModeLowNoiseLowPower = 1 << 8,
         ModeHighResolution = 2 << 8,
         ModeLowPower = 3 << 8,
 
+        //! Switches to the sleep rate and mode when no wake-up event occurs for the time set by @ref ConfigureWake
+        AutoSleep = 4 << 8,
+
+        SleepModeNormal = 0 << 11,
+        SleepModeLowNoiseLowPower = 1 << 11,
+        SleepModeHighResolution = 2 << 11,
+        SleepModeLowPower = 3 << 11,
+
         // values for XYZ_DATA_CG
         Scale2g = 0 << 16,
         Scale4g = 1 << 16,
         Scale8g = 2 << 16,
+
+        //! Output data (and FIFO) are high-pass filtered
+        HighPassOutput = 0x10 << 16,
+    };
+
+    //! Events signalled by the device, INT_SOURCE bits
+    enum struct Event : uint8_t
+    {
+        DataReady = 0x01,
+        //! Motion or free-fall detected, see @ref ConfigureMotion
+        Motion = 0x04,
+        //! Portrait/landscape orientation changed, see @ref ConfigureOrientation
+        Orientation = 0x10,
+        //! Transient acceleration detected, see @ref ConfigureTransient
+        Transient = 0x20,
+        //! FIFO watermark reached or FIFO overflow
+        Fifo = 0x40,
+        //! Transition between the wake and auto-sleep rates
+        SleepWake = 0x80,
+    };
+
+    DECLARE_FLAG_ENUM(Event);
+
+    //! Interrupt pin
+    enum struct IntPin
+    {
+        Int1,
+        Int2,
+    };
+
+    //! Axes participating in motion and transient detection
+    enum struct Axis : uint8_t
+    {
+        X = 1,
+        Y = 2,
+        Z = 4,
+        All = 7,
+    };
+
+    DECLARE_FLAG_ENUM(Axis);
+
+    //! FIFO mode, available only on MMA8451
+    enum struct FifoMode : uint8_t
+    {
+        Disabled = 0,
+        //! The oldest samples are discarded when the FIFO is full
+        Circular = 1,
+        //! Sampling stops when the FIFO is full
+        Fill = 2,
+        //! Circular until an event, then filled with the samples following it
+        Trigger = 3,
+    };
+
+    //! Sampling level, e.g. one of the levels selected by an @ref AdaptiveRate
+    struct RateLevel
+    {
+        //! One of the Config::Rate* values
+        Config rate;
+        //! FIFO watermark in samples (0-32), MMA8451 only
+        uint8_t watermark;
+    };
+
+    //! FIFO entry in normal mode
+    PACKED_UNALIGNED_STRUCT FifoSample
+    {
+        int16_t x, y, z;
+    };
+
+    //! FIFO entry in fast-read mode, see @ref Config::FastRead
+    PACKED_UNALIGNED_STRUCT FastFifoSample
+    {
+        int8_t x, y, z;
     };
 
     MMA845x(bus::I2C i2c, Address address)
@@ -69,6 +158,72 @@ public:
     //! Checks if the measurements are running
     bool IsActive() const { return cfgActual.IsActive(); }
 
+    //! Configures transient (high-pass filtered) acceleration detection, the usual wake-on-motion source
+    //! @param threshold threshold in units of 0.063 g (0-127)
+    //! @param count number of consecutive samples over the threshold (debounce)
+    void ConfigureTransient(Axis axes, uint8_t threshold, uint8_t count = 0)
+    {
+        // TRANSIENT_CFG: ELE, xTEFE
+        detDesired.transCfg = 0x10 | uint8_t(axes) << 1;
+        detDesired.transThs = threshold & 0x7F;
+        detDesired.transCount = count;
+    }
+    //! Configures motion or free-fall detection
+    //! @param threshold threshold in units of 0.063 g (0-127)
+    //! @param count number of consecutive samples over (below for free-fall) the threshold (debounce)
+    //! @param freefall detects all selected axes below the threshold instead of any axis above it
+    void ConfigureMotion(Axis axes, uint8_t threshold, uint8_t count = 0, bool freefall = false)
+    {
+        // FF_MT_CFG: ELE, OAE, xEFE
+        detDesired.ffmtCfg = 0x80 | (freefall ? 0 : 0x40) | uint8_t(axes) << 3;
+        detDesired.ffmtThs = threshold & 0x7F;
+        detDesired.ffmtCount = count;
+    }
+    //! Configures portrait/landscape orientation detection
+    //! @param count number of consecutive samples in the new orientation (debounce)
+    void ConfigureOrientation(bool enable, uint8_t count = 0)
+    {
+        // PL_CFG: DBCNTM (reset default), PL_EN
+        detDesired.plCfg = 0x80 | (enable ? 0x40 : 0);
+        detDesired.plCount = count;
+    }
+    //! Configures the events that keep the device awake when @ref Config::AutoSleep is enabled
+    //! @param sleepCount inactivity time before entering auto-sleep, in units of 320 ms (640 ms at 1.56 Hz)
+    void ConfigureWake(Event sources, uint8_t sleepCount)
+    {
+        // CTRL_REG3 WAKE_x bits are INT_SOURCE bits shifted by one
+        auto wake = sources & (Event::Motion | Event::Orientation | Event::Transient);
+        cfgDesired.ctl.reg3 = (cfgDesired.ctl.reg3 & (Control3::ActiveHigh | Control3::OpenDrain)) | Control3(uint8_t(wake) << 1);
+        cfgDesired.ctl.aslpCount = sleepCount;
+    }
+    //! Configures the electrical properties of the interrupt pins, active low push-pull by default
+    void ConfigureInterruptPins(bool activeHigh, bool openDrain = false)
+    {
+        cfgDesired.ctl.reg3 = (cfgDesired.ctl.reg3 & ~(Control3::ActiveHigh | Control3::OpenDrain)) |
+            (activeHigh ? Control3::ActiveHigh : Control3(0)) | (openDrain ? Control3::OpenDrain : Control3(0));
+    }
+    //! Enables events and routes them to an interrupt pin, replacing the events previously routed to it;
+    //! the pin remains asserted until the events are read by @ref ReadEvents
+    void RouteEvents(IntPin pin, Event events)
+    {
+        // CTRL_REG4 enables the events, CTRL_REG5 selects INT1 (set) or INT2 (cleared)
+        auto& enabled = cfgDesired.ctl.reg4;
+        auto& int1 = cfgDesired.ctl.reg5;
+        auto previous = enabled & (pin == IntPin::Int1 ? int1 : ~int1);
+        enabled = (enabled & ~previous) | events;
+        int1 = pin == IntPin::Int1 ? int1 | events : int1 & ~events;
+    }
+    //! Configures the FIFO (MMA8451 only), samples are read using @ref ReadFifo
+    //! @param watermark number of samples that trigger @ref Event::Fifo, zero disables the watermark
+    void ConfigureFifo(FifoMode mode, uint8_t watermark = 0) { cfgDesired.fsetup = uint8_t(mode) << 6 | (watermark & 0x3F); }
+    //! Switches to a different sampling level, the change is written by @ref ApplyConfiguration,
+    //! which briefly puts the device in standby as the output data rate cannot be changed while active
+    void Configure(const RateLevel& level)
+    {
+        cfgDesired.ctl.reg1 = (cfgDesired.ctl.reg1 & ~Control1::RateMask) | (Control1(level.rate) & Control1::RateMask);
+        cfgDesired.fsetup = (cfgDesired.fsetup & 0xC0) | (level.watermark & 0x3F);
+    }
+
     //! Initializes the sensor
     async(Init);
     //! Updates sensor configuration
@@ -79,6 +234,43 @@ public:
     async(Stop);
     //! Retrieves the last measurement result, return value indicates if the measured values have changed in the meantime
     async(Measure);
+    //! Applies configuration changes made by the synchronous Configure* methods
+    async(ApplyConfiguration);
+    //! Reads up to @p count samples from the FIFO in a single burst, returns the number of samples read
+    async(ReadFifo, FifoSample* buffer, size_t count) { return async_forward(ReadFifoImpl, buffer, count, sizeof(FifoSample)); }
+    //! Reads up to @p count fast-read samples from the FIFO in a single burst, returns the number of samples read
+    async(ReadFifo, FastFifoSample* buffer, size_t count) { return async_forward(ReadFifoImpl, buffer, count, sizeof(FastFifoSample)); }
+    //! Reads up to @p n samples from the FIFO in a single burst, returns the number of samples read
+    template<typename T, size_t n> async(ReadFifo, T (&buffer)[n]) { return async_forward(ReadFifo, buffer, n); }
+    //! Reads and clears the pending events, returns a combination of @ref Event flags,
+    //! the details are available through @ref GetMotionSource, @ref GetTransientSource and @ref GetOrientationSource
+    async(ReadEvents);
+    //! Sleeps until an event is signalled on @p pin, which must be connected to the interrupt pin
+    //! to which the events are routed, and reads the events, see @ref ReadEvents
+    async(WaitForEvents, GPIOPin pin);
+
+    //! Gets the raw FF_MT_SRC value captured by the last @ref ReadEvents
+    uint8_t GetMotionSource() const { return motionSource; }
+    //! Gets the raw TRANSIENT_SRC value captured by the last @ref ReadEvents
+    uint8_t GetTransientSource() const { return transientSource; }
+    //! Gets the raw PL_STATUS value captured by the last @ref ReadEvents
+    uint8_t GetOrientationSource() const { return orientationSource; }
+
+    //! Converts a FIFO sample to acceleration in g (standard gravity)
+    Vector3 FifoSampleValue(const FifoSample& smp) const
+    {
+        return { int16_t(FROM_BE16(smp.x)) * mul, int16_t(FROM_BE16(smp.y)) * mul, int16_t(FROM_BE16(smp.z)) * mul };
+    }
+    //! Converts a fast-read FIFO sample to acceleration in g (standard gravity)
+    Vector3 FifoSampleValue(const FastFifoSample& smp) const
+    {
+        return { smp.x * mul * 256, smp.y * mul * 256, smp.z * mul * 256 };
+    }
+
+#if SENSOR_STATS
+    //! Gets the bus transfer and measurement statistics
+    using I2CSensor::Statistics;
+#endif
 
 protected:
     const char* DebugComponent() const { return "MMA845x"; }
@@ -91,12 +283,29 @@ private:
         OutYH = 3, OutYL = 4,
         OutZH = 5, OutZL = 6,
 
+        FifoSetup = 0x09,
+        TriggerConfig = 0x0A,
         SysMode = 0x0B,
         IntSource = 0x0C,
         ID = 0x0D,
         DataConfig = 0x0E,
         HighPassCutoff = 0x0F,
 
+        PlStatus = 0x10,
+        PlConfig = 0x11,
+        PlCount = 0x12,
+        PlBfZComp = 0x13,
+        PlThreshold = 0x14,
+        FfMtConfig = 0x15,
+        FfMtSource = 0x16,
+        FfMtThreshold = 0x17,
+        FfMtCount = 0x18,
+        TransientConfig = 0x1D,
+        TransientSource = 0x1E,
+        TransientThreshold = 0x1F,
+        TransientCount = 0x20,
+
+        AslpCount = 0x29,
         Control1 = 0x2A,
         Control2 = 0x2B,
         Control3 = 0x2C,
@@ -151,6 +360,9 @@ private:
         Rate12p5Hz = 5 << 3,
         Rate6p25Hz = 6 << 3,
         Rate1p56Hz = 7 << 3,
+
+        RateMask = 7 << 3,
+        AslpRateMask = 3 << 6,
     };
 
     enum struct Control2 : uint8_t
@@ -162,42 +374,145 @@ private:
         ModeHighResolution = 2,
         ModeLowPower = 3,
 
+        AutoSleep = 1 << 2,
+
         Reset = 1 << 6,
         SelfTest = 1 << 7,
     };
 
+    enum struct Control3 : uint8_t
+    {
+        _Default = 0,
+
+        OpenDrain = 1,
+        ActiveHigh = 2,
+
+        WakeMotion = 1 << 3,
+        WakePulse = 1 << 4,
+        WakeOrientation = 1 << 5,
+        WakeTransient = 1 << 6,
+        FifoGate = 1 << 7,
+    };
+
+    //! F_STATUS bits, replacing STATUS when the FIFO is enabled
+    enum
+    {
+        FifoCountMask = 0x3F,
+        FifoWatermark = 0x40,
+        FifoOverflow = 0x80,
+    };
+
     DECLARE_FLAG_ENUM(Status);
     DECLARE_FLAG_ENUM(Control1);
     DECLARE_FLAG_ENUM(Control2);
+    DECLARE_FLAG_ENUM(Control3);
 
     async(UpdateConfiguration);
+    //! Drains the FIFO, @p size is the size of a single sample in the current read mode
+    //! A failed burst is not repeated, its samples are counted as dropped, together with the rest
+    //! of the FIFO if the device cannot be recovered
+    async(ReadFifoImpl, void* buffer, size_t count, size_t size);
+
+    //! Checks the STATUS (or F_STATUS when the FIFO is enabled) register for new data
+    bool DataReady(Status status) const
+    {
+        return cfgActual.IsFifo() ? !!(uint8_t(status) & FifoCountMask) : (status & Status::ReadyAll) == Status::ReadyAll;
+    }
+    //! Reads registers, climbing the recovery ladder if the transaction fails
+    async(ReadRegisterRecover, Register reg, Buffer buf);
+    //! Verifies the device state after repeated failures, restoring the configuration
+    //! without a reset if possible, forces a full reinitialization only as a last resort
+    async(Recover);
+    //! Counts FIFO samples lost to a failed recovery, @p popped already removed and the ones still queued,
+    //! which are flushed by the reinitialization that follows
+    async(CountFifoLoss, size_t popped);
 
     bool init = false;
     IDValue id;
 
-    struct
+    struct ConfigRegisters
     {
         DataConfig dcfg = DataConfig::_Default;
+        //! F_SETUP, MMA8451 only
+        uint8_t fsetup = 0;
         struct
         {
+            uint8_t aslpCount = 0;
             Control1 reg1 = Control1::_Default;
             Control2 reg2 = Control2::_Default;
+            Control3 reg3 = Control3::_Default;
+            Event reg4 = Event(0);
+            Event reg5 = Event(0);
         } ctl;
 
         float GetScale() const { return BYTES(2, 4, 8, 12)[uint8_t(dcfg) & 3]; }
         bool IsActive() const { return !!(ctl.reg1 & Control1::Active); }
+        bool IsFastRead() const { return !!(ctl.reg1 & Control1::FastRead); }
+        bool IsFifo() const { return fsetup & 0xC0; }
 
         //! Gets value for comparing actual vs. desired
-        uint32_t CompareValue() const { return (uint8_t)dcfg | ((uint8_t)(ctl.reg1 & ~Control1::Active) << 8) | ((uint8_t)ctl.reg2 << 16); }
+        uint64_t CompareValue() const
+        {
+            return (uint8_t)dcfg | (fsetup << 8) | (ctl.aslpCount << 16) | (uint32_t((uint8_t)(ctl.reg1 & ~Control1::Active)) << 24) |
+                (uint64_t((uint8_t)ctl.reg2 | ((uint8_t)ctl.reg3 << 8) | ((uint8_t)ctl.reg4 << 16) | ((uint32_t)ctl.reg5 << 24)) << 32);
+        }
     } cfgActual, cfgDesired;
 
+    //! Orientation, motion and transient detection registers, PL_CFG - TRANSIENT_COUNT,
+    //! initialized to the reset values
+    struct DetectionRegisters
+    {
+        uint8_t plCfg = 0x80;
+        uint8_t plCount = 0;
+        uint8_t plBfZComp = 0x44;
+        uint8_t plThs = 0x84;
+        uint8_t ffmtCfg = 0;
+        uint8_t ffmtSrc = 0;
+        uint8_t ffmtThs = 0;
+        uint8_t ffmtCount = 0;
+        uint8_t resvd[4] = {};
+        uint8_t transCfg = 0;
+        uint8_t transSrc = 0;
+        uint8_t transThs = 0;
+        uint8_t transCount = 0;
+    } detActual, detDesired;
+
+    //! Source and reserved registers within @ref DetectionRegisters, never written
+    static constexpr uint32_t DetectionVolatile = BIT(5) | BIT(8) | BIT(9) | BIT(10) | BIT(11) | BIT(13);
+
+    uint8_t motionSource = 0, transientSource = 0, orientationSource = 0;
+
     float x = NAN, y = NAN, z = NAN;
     float mul;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Stop = { FrameSize<>, RegisterFrameSize };
+        // UpdateConfiguration restarts only a device that was active, hence initialized, so its Start never nests Init
+        static constexpr FrameEntry Restart = { FrameSize<>, RegisterFrameSize };
+        static constexpr FrameEntry UpdateConfiguration = { FrameSize<bool>, FrameMax(Stop, Restart, RegisterFrameSize) };
+        static constexpr FrameEntry Init = { FrameSize<Control2>, FrameMax(UpdateConfiguration, RegisterFrameSize) };
+        static constexpr FrameEntry Start = { FrameSize<>, FrameMax(Init, RegisterFrameSize) };
+        static constexpr FrameEntry Configure = { FrameSize<>, UpdateConfiguration };
+        static constexpr FrameEntry ApplyConfiguration = { FrameSize<>, FrameMax(Init, UpdateConfiguration) };
+        static constexpr FrameEntry Recover = { FrameSize<IDValue, ConfigRegisters, bool>, FrameMax(UpdateConfiguration, Start, Stop, RegisterFrameSize) };
+        static constexpr FrameEntry ReadRegisterRecover = { FrameSize<>, FrameMax(Recover, RegisterFrameSize) };
+        static constexpr FrameEntry Measure = { FrameSize<uint8_t[1 + 3 * sizeof(int16_t)], FrameStatsStart>, FrameMax(Start, ReadRegisterRecover) };
+        static constexpr FrameEntry CountFifoLoss = { FrameSize<size_t, uint8_t>, RegisterFrameSize };
+        static constexpr FrameEntry ReadFifoImpl = { FrameSize<uint8_t, size_t>, FrameMax(Start, Recover, CountFifoLoss, RegisterFrameSize) };
+        static constexpr FrameEntry ReadEvents = { FrameSize<uint8_t[2]>, FrameMax(Init, RegisterFrameSize) };
+        static constexpr FrameEntry WaitForEvents = { FrameSize<>, FrameMax(SENSOR_FRAME_BUS, ReadEvents) };    // GPIOPin::WaitFor
+    };
 };
 
 DEFINE_FLAG_ENUM(MMA845x::Config);
 DEFINE_FLAG_ENUM(MMA845x::Status);
 DEFINE_FLAG_ENUM(MMA845x::Control1);
 DEFINE_FLAG_ENUM(MMA845x::Control2);
+DEFINE_FLAG_ENUM(MMA845x::Control3);
+DEFINE_FLAG_ENUM(MMA845x::Event);
+DEFINE_FLAG_ENUM(MMA845x::Axis);
 
 }
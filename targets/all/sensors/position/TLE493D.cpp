@@ -15,30 +15,12 @@ async(TLE493D::Init)
 async_def(
     union
     {
-        struct
-        {
-            uint8_t _discard_data_regs[6];
-            Diagnostics diag;
-            uint8_t _discard_wake_regs[9];
-            Config cfg;
-            Mode1 mode1;
-            uint8_t _reserved12;
-            uint8_t _reserved13 : 5;
-            uint8_t prd : 3;
-            uint8_t _reserved14, _reserved15;
-            uint8_t rev : 4;
-            uint8_t feat: 2;
-            uint8_t : 2;
-        } data;
-        struct
-        {
-            Register reg;
-            Config cfg;
-            Mode1 mode1;
-        } init;
+        RegisterDump data;
+        InitWrite init;
     };
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Init);
     // we must start by configuring the protocol of the sensor, as it stars in a mode where reads are not I2C compatible
     MYDBG("Configuring...");
     f.init.reg = Register::Config;
@@ -76,19 +58,10 @@ async_end
 
 async(TLE493D::Measure)
 async_def(
-    struct
-    {
-        int8_t bx, by, bz;
-        uint8_t temp;
-        uint8_t byl : 4;
-        uint8_t bxl : 4;
-        uint8_t bzl : 4;
-        uint8_t id : 2;
-        uint8_t templ : 2;
-        Diagnostics diag;
-    } data;
+    MeasureData data;
 )
 {
+    SENSOR_FRAME_FIELDS(FrameSizes::Measure);
     if (!init && !await(Init))
     {
         async_return(false);
@@ -108,4 +81,11 @@ async_def(
 }
 async_end
 
+#ifndef SENSOR_FRAME_BUDGET_TLE493D
+#define SENSOR_FRAME_BUDGET_TLE493D    SENSOR_FRAME_BUDGET
+#endif
+
+SENSOR_FRAME_CHECK(TLE493D, Init, TLE493D::FrameSizes::Init);
+SENSOR_FRAME_CHECK(TLE493D, Measure, TLE493D::FrameSizes::Measure);
+
 }
@@ -120,6 +120,44 @@ private:
     DECLARE_FLAG_ENUM(Config);
     DECLARE_FLAG_ENUM(Mode1);
 
+    //! Complete register block read by @ref Init
+    struct RegisterDump
+    {
+        uint8_t _discard_data_regs[6];
+        Diagnostics diag;
+        uint8_t _discard_wake_regs[9];
+        Config cfg;
+        Mode1 mode1;
+        uint8_t _reserved12;
+        uint8_t _reserved13 : 5;
+        uint8_t prd : 3;
+        uint8_t _reserved14, _reserved15;
+        uint8_t rev : 4;
+        uint8_t feat: 2;
+        uint8_t : 2;
+    };
+
+    //! Configuration written by @ref Init
+    struct InitWrite
+    {
+        Register reg;
+        Config cfg;
+        Mode1 mode1;
+    };
+
+    //! Output block read by @ref Measure
+    struct MeasureData
+    {
+        int8_t bx, by, bz;
+        uint8_t temp;
+        uint8_t byl : 4;
+        uint8_t bxl : 4;
+        uint8_t bzl : 4;
+        uint8_t id : 2;
+        uint8_t templ : 2;
+        Diagnostics diag;
+    };
+
     //! Returns the configred address in Mode1 register format
     Mode1 Mode1Address() const { return (Mode1::Address2 * GETBIT(BusAddress(), 6)) | (Mode1::Address1 * !GETBIT(BusAddress(), 4)); }
 
@@ -127,6 +165,14 @@ private:
     float x = NAN, y = NAN, z = NAN;
 
     static constexpr float ValueMultiply = 200 / 2048.0;
+
+public:
+    //! Worst-case sizes of the nested async frames, see @ref FrameBudget.h
+    struct FrameSizes
+    {
+        static constexpr FrameEntry Init = { FrameMax(FrameSize<RegisterDump>, FrameSize<InitWrite>), BusFrameSize };
+        static constexpr FrameEntry Measure = { FrameSize<MeasureData>, FrameMax(Init, BusFrameSize) };
+    };
 };
 
 DEFINE_FLAG_ENUM(TLE493D::Diagnostics);